@@ -0,0 +1,75 @@
+#!/bin/sh
+# Profile-guided release build of the simulation, compared against -O2
+# builds with and without LTO.
+#
+#   scripts/pgo.sh [build dir] [frames per level]
+#
+# Stage one builds instrumented binaries and trains them on a fixed
+# headless workload. The workload is levels 1..40 of the benchmark, long
+# enough per level to run through the fast and reverse rotation phases
+# that start at level 9, followed by an endless run to 5000 pins. Stage two
+# rebuilds with the profile and LTO. It is timed on the same workload
+# against an -O2 build with LTO, so the PGO gain is measured on its own, and
+# against a plain -O2 one.
+#
+# The profile stays in the pgo build directory; building the game there
+# with -DAA_PGO=USE uses it too (see README).
+set -e
+
+root=$(cd "$(dirname "$0")/.." && pwd)
+build=${1:-$root/_pgo_build}
+frames=${2:-20000}
+runs=3
+pgo_dir=$build/pgo/profiles
+
+train() {
+    "$1/aa_bench" 40 "$frames" > /dev/null
+    "$1/aa_bench" --endless 5000 > /dev/null
+}
+
+# Best ns/frame of several runs of the level workload
+measure() {
+    i=0
+    while [ $i -lt $runs ]; do
+        "$1/aa_bench" 40 "$frames" | sed -n 's/^total:.* \([0-9.]*\) ns\/frame.*/\1/p'
+        i=$((i + 1))
+    done | sort -n | head -n 1
+}
+
+build_bench() {
+    dir=$1
+    shift
+    cmake -S "$root" -B "$dir" -DCMAKE_BUILD_TYPE=Release -DCMAKE_C_FLAGS_RELEASE=-O2 \
+          -DAA_PGO_DIR="$pgo_dir" "$@" > /dev/null
+    cmake --build "$dir" -j --target aa_bench > /dev/null
+}
+
+echo "plain -O2 build"
+build_bench "$build/plain" -DAA_LTO=OFF -DAA_PGO=OFF
+
+echo "LTO build"
+build_bench "$build/lto" -DAA_LTO=ON -DAA_PGO=OFF
+
+echo "instrumented build"
+rm -rf "$pgo_dir"
+mkdir -p "$pgo_dir"
+find "$build/pgo" -name '*.gcda' -delete 2>/dev/null || true
+build_bench "$build/pgo" -DAA_LTO=ON -DAA_PGO=GENERATE
+
+echo "training"
+train "$build/pgo"
+if ls "$pgo_dir"/*.profraw > /dev/null 2>&1; then
+    llvm-profdata merge -o "$pgo_dir/default.profdata" "$pgo_dir"/*.profraw
+fi
+
+echo "optimised build"
+build_bench "$build/pgo" -DAA_LTO=ON -DAA_PGO=USE
+
+plain=$(measure "$build/plain")
+lto=$(measure "$build/lto")
+pgo=$(measure "$build/pgo")
+echo "plain -O2:     $plain ns/frame"
+echo "LTO:           $lto ns/frame"
+echo "PGO + LTO:     $pgo ns/frame"
+awk -v a="$plain" -v b="$lto" 'BEGIN { printf "LTO is %.1f%% faster than plain -O2\n", (a - b) * 100 / a }'
+awk -v a="$lto" -v b="$pgo" 'BEGIN { printf "PGO is %.1f%% faster than LTO alone\n", (a - b) * 100 / a }'
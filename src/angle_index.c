@@ -0,0 +1,44 @@
+#include "angle_index.h"
+#include <string.h>
+
+void AngleIndexClear(AngleIndex *index) {
+    index->count = 0;
+}
+
+// First position whose angle is >= angle
+static int LowerBound(const AngleIndex *index, BinaryAngle angle) {
+    int lo = 0, hi = index->count;
+    while (lo < hi) {
+        int mid = (lo + hi) / 2;
+        if (index->angles[mid] < angle) lo = mid + 1;
+        else hi = mid;
+    }
+    return lo;
+}
+
+void AngleIndexInsert(AngleIndex *index, BinaryAngle angle, int pin) {
+    if (index->count >= ANGLE_INDEX_CAPACITY) return;
+
+    int pos = LowerBound(index, angle);
+    int tail = index->count - pos;
+    memmove(&index->angles[pos + 1], &index->angles[pos], tail * sizeof(index->angles[0]));
+    memmove(&index->pins[pos + 1], &index->pins[pos], tail * sizeof(index->pins[0]));
+    index->angles[pos] = angle;
+    index->pins[pos] = pin;
+    index->count++;
+}
+
+int AngleIndexFindNear(const AngleIndex *index, BinaryAngle angle, BinaryAngle threshold, int hits[2]) {
+    int n = index->count;
+    if (n == 0) return 0;
+
+    // The neighbours wrap around: the one before the first entry is the last
+    int pos = LowerBound(index, angle);
+    int next = (pos == n) ? 0 : pos;
+    int prev = (pos == 0) ? n - 1 : pos - 1;
+
+    int found = 0;
+    if (AnglesWithin(angle, index->angles[next], threshold)) hits[found++] = index->pins[next];
+    if (prev != next && AnglesWithin(angle, index->angles[prev], threshold)) hits[found++] = index->pins[prev];
+    return found;
+}
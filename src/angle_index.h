@@ -0,0 +1,25 @@
+#ifndef ANGLE_INDEX_H
+#define ANGLE_INDEX_H
+
+#include "binary_angle.h"
+
+#define ANGLE_INDEX_CAPACITY 256
+
+// Attached pins kept sorted by their angle on the board. Every attached pin
+// turns by the same amount each frame, so the angles stored here are
+// relative to the board rotation and never change once inserted.
+typedef struct {
+    BinaryAngle angles[ANGLE_INDEX_CAPACITY];
+    int pins[ANGLE_INDEX_CAPACITY];
+    int count;
+} AngleIndex;
+
+void AngleIndexClear(AngleIndex *index);
+void AngleIndexInsert(AngleIndex *index, BinaryAngle angle, int pin);
+
+// Finds the stored pins on either side of angle that are closer than
+// threshold. Returns how many were found (0, 1 or 2) and writes
+// their pin numbers to hits.
+int AngleIndexFindNear(const AngleIndex *index, BinaryAngle angle, BinaryAngle threshold, int hits[2]);
+
+#endif
@@ -0,0 +1,57 @@
+#include "asset_pack.h"
+#include <string.h>
+
+_Static_assert(sizeof(AssetPackHeader) == 32, "asset pack header must be 32 bytes");
+_Static_assert(sizeof(AssetEntry) == 64, "asset entry must be 64 bytes");
+
+static bool ValidPack(const AssetPack *pack) {
+    size_t size = pack->file.size;
+    if (size < sizeof(AssetPackHeader)) return false;
+    const AssetPackHeader *header = pack->header;
+    if (memcmp(header->magic, ASSET_PACK_MAGIC, 4) != 0 || header->version != ASSET_PACK_VERSION) return false;
+    if (header->indexOffset % 8 != 0) return false;
+    if ((uint64_t)header->indexOffset + (uint64_t)header->entryCount * sizeof(AssetEntry) > size) return false;
+
+    const AssetEntry *entries = (const AssetEntry *)((const char *)pack->file.data + header->indexOffset);
+    for (uint32_t i = 0; i < header->entryCount; i++) {
+        const AssetEntry *entry = &entries[i];
+        if ((uint64_t)entry->offset + entry->size > size) return false;
+        if (entry->name[ASSET_NAME_LENGTH - 1] != '\0') return false;
+        // PCM is played straight from the entry, so its frames must fit in it
+        if (entry->type == ASSET_PCM) {
+            if (entry->sampleSize == 0 || entry->sampleSize % 8 != 0) return false;
+            if ((uint64_t)entry->frameCount * entry->channels * (entry->sampleSize / 8) > entry->size) return false;
+        }
+    }
+    return true;
+}
+
+bool LoadAssetPack(AssetPack *pack, const char *path) {
+    memset(pack, 0, sizeof(*pack));
+    if (!MapFile(&pack->file, path)) return false;
+
+    pack->header = pack->file.data;
+    if (!ValidPack(pack)) {
+        UnloadAssetPack(pack);
+        return false;
+    }
+    pack->entries = (const AssetEntry *)((const char *)pack->file.data + pack->header->indexOffset);
+    return true;
+}
+
+void UnloadAssetPack(AssetPack *pack) {
+    UnmapFile(&pack->file);
+    memset(pack, 0, sizeof(*pack));
+}
+
+const AssetEntry *FindAsset(const AssetPack *pack, const char *name) {
+    if (!pack || !pack->file.data) return NULL;
+    for (uint32_t i = 0; i < pack->header->entryCount; i++) {
+        if (strcmp(pack->entries[i].name, name) == 0) return &pack->entries[i];
+    }
+    return NULL;
+}
+
+const void *AssetData(const AssetPack *pack, const AssetEntry *entry) {
+    return (const char *)pack->file.data + entry->offset;
+}
@@ -0,0 +1,53 @@
+#ifndef ASSET_PACK_H
+#define ASSET_PACK_H
+
+#include "mapped_file.h"
+#include <stdint.h>
+
+// Asset archives: a 32 byte AssetPackHeader, then entryCount 64 byte
+// AssetEntries, then the asset data with every asset starting on a
+// ASSET_ALIGNMENT byte boundary. Everything is little-endian. Archives are
+// memory-mapped and assets are used in place.
+#define ASSET_PACK_MAGIC "AAPK"
+#define ASSET_PACK_VERSION 1
+#define ASSET_ALIGNMENT 64
+#define ASSET_NAME_LENGTH 40
+
+typedef enum {
+    ASSET_RAW = 0,      // file contents as they were, e.g. an mp3 stream
+    ASSET_PCM = 1,      // decoded interleaved PCM samples
+} AssetType;
+
+typedef struct {
+    char magic[4];
+    uint32_t version;
+    uint32_t entryCount;
+    uint32_t indexOffset;
+    uint32_t reserved[4];
+} AssetPackHeader;
+
+typedef struct {
+    char name[ASSET_NAME_LENGTH];
+    uint32_t type;
+    uint32_t offset;
+    uint32_t size;
+    uint32_t sampleRate;    // PCM only
+    uint16_t channels;
+    uint16_t sampleSize;    // bits per sample
+    uint32_t frameCount;
+} AssetEntry;
+
+typedef struct {
+    MappedFile file;
+    const AssetPackHeader *header;
+    const AssetEntry *entries;
+} AssetPack;
+
+bool LoadAssetPack(AssetPack *pack, const char *path);
+void UnloadAssetPack(AssetPack *pack);
+
+// Entry with the given name, or NULL
+const AssetEntry *FindAsset(const AssetPack *pack, const char *name);
+const void *AssetData(const AssetPack *pack, const AssetEntry *entry);
+
+#endif
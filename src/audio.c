@@ -0,0 +1,259 @@
+#include "audio.h"
+#include "raylib.h"
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define MIX_SAMPLE_RATE 44100
+#define MIX_CHANNELS 2
+#define MAX_VOICES 8
+#define COMMAND_QUEUE_SIZE 64       // power of two
+#define AUDIO_THREAD_PERIOD 0.005   // seconds between music updates
+
+#define MUSIC_ASSET "Flying_me_softly.mp3"
+static const char *effectAssets[SOUND_COUNT] = {
+    [SOUND_PIN] = "pin.wav",
+    [SOUND_FAIL] = "fail.mp3",
+    [SOUND_BEEP] = "beep.mp3",
+};
+
+typedef enum {
+    COMMAND_PLAY_EFFECT,
+} CommandType;
+
+typedef struct {
+    CommandType type;
+    int effect;
+} AudioCommand;
+
+// Single producer, single consumer ring
+typedef struct {
+    AudioCommand items[COMMAND_QUEUE_SIZE];
+    atomic_uint head;   // next slot to read, owned by the consumer
+    atomic_uint tail;   // next slot to write, owned by the producer
+} CommandQueue;
+
+typedef struct {
+    const short *samples;   // interleaved stereo
+    unsigned int frames;
+    bool owned;             // false when pointing into the asset pack
+} EffectData;
+
+typedef struct {
+    int effect;         // -1 when free
+    unsigned int position;
+} Voice;
+
+static CommandQueue effectQueue;    // game thread -> mixer callback
+static EffectData effects[SOUND_COUNT];
+static Voice voices[MAX_VOICES];
+static unsigned int frameEffects = 0;
+
+static Music music;
+static AudioStream mixer;
+static pthread_t audioThread;
+static pthread_t loaderThread;
+static bool loaderStarted = false;
+static atomic_bool audioRunning;
+// Only the latest play/pause request matters, so it is a flag rather than
+// a queued command
+static atomic_bool musicWanted;
+static atomic_bool initialized;
+static double readyTime = 0.0;
+// Time the audio thread spent in UpdateMusicStream() since last taken
+static atomic_llong musicUpdateNs;
+
+static bool PushCommand(CommandQueue *queue, AudioCommand command) {
+    unsigned int tail = atomic_load_explicit(&queue->tail, memory_order_relaxed);
+    unsigned int head = atomic_load_explicit(&queue->head, memory_order_acquire);
+    if (tail - head == COMMAND_QUEUE_SIZE) return false;
+    queue->items[tail % COMMAND_QUEUE_SIZE] = command;
+    atomic_store_explicit(&queue->tail, tail + 1, memory_order_release);
+    return true;
+}
+
+static bool PopCommand(CommandQueue *queue, AudioCommand *command) {
+    unsigned int head = atomic_load_explicit(&queue->head, memory_order_relaxed);
+    unsigned int tail = atomic_load_explicit(&queue->tail, memory_order_acquire);
+    if (head == tail) return false;
+    *command = queue->items[head % COMMAND_QUEUE_SIZE];
+    atomic_store_explicit(&queue->head, head + 1, memory_order_release);
+    return true;
+}
+
+static void StartVoice(int effect) {
+    // Take a free voice, or steal the one that has played the longest
+    int chosen = 0;
+    for (int i = 0; i < MAX_VOICES; i++) {
+        if (voices[i].effect < 0) {
+            chosen = i;
+            break;
+        }
+        if (voices[i].position > voices[chosen].position) chosen = i;
+    }
+    voices[chosen].effect = effect;
+    voices[chosen].position = 0;
+}
+
+// Runs on the audio device thread
+static void MixEffects(void *buffer, unsigned int frames) {
+    AudioCommand command;
+    while (PopCommand(&effectQueue, &command)) {
+        if (command.type == COMMAND_PLAY_EFFECT) StartVoice(command.effect);
+    }
+
+    short *out = buffer;
+    memset(out, 0, frames * MIX_CHANNELS * sizeof(short));
+    for (int v = 0; v < MAX_VOICES; v++) {
+        Voice *voice = &voices[v];
+        if (voice->effect < 0) continue;
+
+        const EffectData *data = &effects[voice->effect];
+        unsigned int count = data->frames - voice->position;
+        if (count > frames) count = frames;
+        const short *in = &data->samples[voice->position * MIX_CHANNELS];
+        for (unsigned int i = 0; i < count * MIX_CHANNELS; i++) {
+            int mixed = out[i] + in[i];
+            out[i] = (mixed > 32767) ? 32767 : (mixed < -32768) ? -32768 : mixed;
+        }
+
+        voice->position += count;
+        if (voice->position >= data->frames) voice->effect = -1;
+    }
+}
+
+static void *AudioThreadMain(void *arg) {
+    (void)arg;
+    bool playing = false;
+    while (atomic_load(&audioRunning)) {
+        bool wanted = atomic_load(&musicWanted);
+        if (wanted && !playing) ResumeMusicStream(music);
+        if (!wanted && playing) PauseMusicStream(music);
+        playing = wanted;
+        double start = GetTime();
+        UpdateMusicStream(music);
+        atomic_fetch_add_explicit(&musicUpdateNs, (long long)((GetTime() - start) * 1e9), memory_order_relaxed);
+        WaitTime(AUDIO_THREAD_PERIOD);
+    }
+    return NULL;
+}
+
+static void LoadEffect(EffectData *effect, const AssetPack *pack, const char *name) {
+    effect->samples = NULL;
+    effect->frames = 0;
+    effect->owned = false;
+
+    const AssetEntry *entry = FindAsset(pack, name);
+    if (entry && entry->type == ASSET_PCM && entry->sampleRate == MIX_SAMPLE_RATE &&
+        entry->channels == MIX_CHANNELS && entry->sampleSize == 16) {
+        effect->samples = AssetData(pack, entry);
+        effect->frames = entry->frameCount;
+        return;
+    }
+
+    // May run on the loader thread, so no TextFormat()
+    char path[64];
+    snprintf(path, sizeof(path), "resources/%s", name);
+    Wave wave = LoadWave(path);
+    if (wave.data == NULL) return;
+
+    WaveFormat(&wave, MIX_SAMPLE_RATE, 16, MIX_CHANNELS);
+    short *samples = malloc(wave.frameCount * MIX_CHANNELS * sizeof(short));
+    memcpy(samples, wave.data, wave.frameCount * MIX_CHANNELS * sizeof(short));
+    effect->samples = samples;
+    effect->frames = wave.frameCount;
+    effect->owned = true;
+    UnloadWave(wave);
+}
+
+bool InitAudioEngine(const AssetPack *pack) {
+    InitAudioDevice();
+    if (!IsAudioDeviceReady()) return false;
+
+    for (int i = 0; i < SOUND_COUNT; i++) LoadEffect(&effects[i], pack, effectAssets[i]);
+    for (int i = 0; i < MAX_VOICES; i++) voices[i].effect = -1;
+
+    mixer = LoadAudioStream(MIX_SAMPLE_RATE, 16, MIX_CHANNELS);
+    SetAudioStreamCallback(mixer, MixEffects);
+    PlayAudioStream(mixer);
+
+    const AssetEntry *entry = FindAsset(pack, MUSIC_ASSET);
+    if (entry && entry->type == ASSET_RAW) {
+        // The decoder reads straight from the mapped archive
+        music = LoadMusicStreamFromMemory(".mp3", AssetData(pack, entry), entry->size);
+    } else {
+        music = LoadMusicStream("resources/" MUSIC_ASSET);
+    }
+    PlayMusicStream(music);
+    PauseMusicStream(music);
+
+    atomic_store(&audioRunning, true);
+    if (pthread_create(&audioThread, NULL, AudioThreadMain, NULL) != 0) {
+        atomic_store(&audioRunning, false);
+    }
+    readyTime = GetTime();
+    atomic_store(&initialized, true);
+    return true;
+}
+
+static void *LoaderMain(void *arg) {
+    InitAudioEngine(arg);
+    return NULL;
+}
+
+void StartAudioEngine(const AssetPack *pack) {
+    loaderStarted = pthread_create(&loaderThread, NULL, LoaderMain, (void *)pack) == 0;
+    if (!loaderStarted) InitAudioEngine(pack);
+}
+
+bool IsAudioEngineReady(void) {
+    return atomic_load(&initialized);
+}
+
+double GetAudioEngineReadyTime(void) {
+    return readyTime;
+}
+
+long long TakeMusicUpdateTime(void) {
+    return atomic_exchange_explicit(&musicUpdateNs, 0, memory_order_relaxed);
+}
+
+void CloseAudioEngine(void) {
+    if (loaderStarted) {
+        pthread_join(loaderThread, NULL);
+        loaderStarted = false;
+    }
+    if (!atomic_load(&initialized)) return;
+    if (atomic_exchange(&audioRunning, false)) pthread_join(audioThread, NULL);
+
+    UnloadAudioStream(mixer);
+    UnloadMusicStream(music);
+    for (int i = 0; i < SOUND_COUNT; i++) {
+        if (effects[i].owned) free((void *)effects[i].samples);
+    }
+    CloseAudioDevice();
+    atomic_store(&initialized, false);
+}
+
+void SetMusicPlaying(bool playing) {
+    atomic_store(&musicWanted, playing);
+}
+
+void AudioPlayEffect(SoundEffect effect) {
+    frameEffects |= 1u << effect;
+}
+
+void AudioEndFrame(void) {
+    if (!atomic_load(&initialized)) {
+        frameEffects = 0;
+        return;
+    }
+    for (int i = 0; i < SOUND_COUNT; i++) {
+        if (!(frameEffects & (1u << i)) || effects[i].frames == 0) continue;
+        AudioCommand command = { COMMAND_PLAY_EFFECT, i };
+        PushCommand(&effectQueue, command);
+    }
+    frameEffects = 0;
+}
@@ -0,0 +1,41 @@
+#ifndef AUDIO_H
+#define AUDIO_H
+
+#include "asset_pack.h"
+#include <stdbool.h>
+
+// Sound effects, pre-decoded to PCM at startup
+typedef enum {
+    SOUND_PIN,
+    SOUND_FAIL,
+    SOUND_BEEP,
+    SOUND_COUNT
+} SoundEffect;
+
+// Music is decoded on a dedicated audio thread and effects are mixed in the
+// device callback from a fixed pool of voices. The game thread only pushes
+// commands into lock-free queues, so a slow frame cannot starve the music.
+//
+// Assets are taken from pack when it has them, used in place without
+// copying, and otherwise loaded from resources/. The pack must stay loaded
+// until CloseAudioEngine().
+bool InitAudioEngine(const AssetPack *pack);
+// Runs InitAudioEngine() on a background thread so startup does not wait
+// for the audio device and decoding. Until it is ready, requests are
+// ignored, except the music state, which is applied once it is.
+void StartAudioEngine(const AssetPack *pack);
+bool IsAudioEngineReady(void);
+// GetTime() at the moment the engine became ready
+double GetAudioEngineReadyTime(void);
+// Nanoseconds the audio thread spent decoding music since the last call
+long long TakeMusicUpdateTime(void);
+void CloseAudioEngine(void);
+
+void SetMusicPlaying(bool playing);
+
+// Effects requested during a frame are played once each, however many
+// times they were requested, when AudioEndFrame() is called.
+void AudioPlayEffect(SoundEffect effect);
+void AudioEndFrame(void);
+
+#endif
@@ -0,0 +1,184 @@
+#include "batch_env.h"
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+
+typedef struct {
+    BatchEnv *env;
+    int first, last;        // boards [first, last)
+    long episodes;
+    pthread_t thread;
+} BatchWorker;
+
+// Workers wait for the step generation to change, step their slice and
+// count down pending. Slice 0 belongs to the calling thread.
+struct BatchPool {
+    pthread_mutex_t lock;
+    pthread_cond_t start;
+    pthread_cond_t done;
+    long generation;
+    int pending;
+    bool quit;
+    const uint8_t *actions;
+    BatchWorker workers[BATCH_MAX_THREADS];
+};
+
+static void Observe(BatchEnv *env, int b) {
+    const PinSet *pins = &env->states[b].pins;
+    int attached = pins->attachedCount < BATCH_OBS_PINS ? pins->attachedCount : BATCH_OBS_PINS;
+    memcpy(env->angles + (size_t)b * BATCH_OBS_PINS, pins->angle, attached * sizeof(BinaryAngle));
+    env->attached[b] = attached;
+    env->remaining[b] = env->states[b].level_pin - pins->count;
+}
+
+static void StepSlice(BatchWorker *worker, const uint8_t *actions) {
+    BatchEnv *env = worker->env;
+    for (int b = worker->first; b < worker->last; b++) {
+        GameState *state = &env->states[b];
+        GameInput input = { .launch = actions[b] != 0 };
+        int events = GameUpdate(state, input);
+
+        uint8_t outcome = BATCH_RUNNING;
+        if (events & GAME_EVENT_LEVEL_PASSED) {
+            outcome = BATCH_PASSED;
+        } else if (events & GAME_EVENT_COLLISION) {
+            outcome = BATCH_FAILED;
+        }
+        if (outcome != BATCH_RUNNING) {
+            StartLevel(state, env->levels[b]);
+            worker->episodes++;
+        }
+        env->outcome[b] = outcome;
+        Observe(env, b);
+    }
+}
+
+static void *WorkerMain(void *arg) {
+    BatchWorker *worker = arg;
+    BatchPool *pool = worker->env->pool;
+    long seen = 0;
+    for (;;) {
+        pthread_mutex_lock(&pool->lock);
+        while (pool->generation == seen && !pool->quit) pthread_cond_wait(&pool->start, &pool->lock);
+        if (pool->quit) {
+            pthread_mutex_unlock(&pool->lock);
+            return NULL;
+        }
+        seen = pool->generation;
+        const uint8_t *actions = pool->actions;
+        pthread_mutex_unlock(&pool->lock);
+
+        StepSlice(worker, actions);
+
+        pthread_mutex_lock(&pool->lock);
+        if (--pool->pending == 0) pthread_cond_signal(&pool->done);
+        pthread_mutex_unlock(&pool->lock);
+    }
+}
+
+bool InitBatchEnv(BatchEnv *env, int boards, int firstLevel, int levelCount, int threads) {
+    memset(env, 0, sizeof(*env));
+    if (boards < 1) return false;
+    if (levelCount < 1) levelCount = 1;
+    if (threads > BATCH_MAX_THREADS) threads = BATCH_MAX_THREADS;
+    if (threads > boards) threads = boards;
+    if (threads < 1) threads = 1;
+
+    env->boards = boards;
+    env->states = calloc(boards, sizeof(GameState));
+    env->levels = malloc(boards * sizeof(int));
+    env->angles = calloc((size_t)boards * BATCH_OBS_PINS, sizeof(BinaryAngle));
+    env->attached = calloc(boards, sizeof(int));
+    env->remaining = calloc(boards, sizeof(int));
+    env->outcome = calloc(boards, sizeof(uint8_t));
+    env->pool = calloc(1, sizeof(BatchPool));
+    if (!env->states || !env->levels || !env->angles || !env->attached || !env->remaining ||
+        !env->outcome || !env->pool) {
+        FreeBatchEnv(env);
+        return false;
+    }
+
+    for (int b = 0; b < boards; b++) {
+        InitGameState(&env->states[b]);
+        env->levels[b] = firstLevel + b % levelCount;
+    }
+    ResetBatchEnv(env);
+
+    BatchPool *pool = env->pool;
+    pthread_mutex_init(&pool->lock, NULL);
+    pthread_cond_init(&pool->start, NULL);
+    pthread_cond_init(&pool->done, NULL);
+    env->threads = threads;
+    for (int t = 0; t < threads; t++) {
+        BatchWorker *worker = &pool->workers[t];
+        worker->env = env;
+        worker->first = (int)((long)boards * t / threads);
+        worker->last = (int)((long)boards * (t + 1) / threads);
+    }
+    for (int t = 1; t < threads; t++) {
+        if (pthread_create(&pool->workers[t].thread, NULL, WorkerMain, &pool->workers[t]) != 0) {
+            // The last thread that did start takes the rest
+            pool->workers[t - 1].last = boards;
+            env->threads = t;
+            break;
+        }
+    }
+    return true;
+}
+
+void FreeBatchEnv(BatchEnv *env) {
+    BatchPool *pool = env->pool;
+    if (pool && env->threads > 0) {
+        pthread_mutex_lock(&pool->lock);
+        pool->quit = true;
+        pthread_cond_broadcast(&pool->start);
+        pthread_mutex_unlock(&pool->lock);
+        for (int t = 1; t < env->threads; t++) pthread_join(pool->workers[t].thread, NULL);
+        pthread_mutex_destroy(&pool->lock);
+        pthread_cond_destroy(&pool->start);
+        pthread_cond_destroy(&pool->done);
+    }
+    if (env->states) {
+        for (int b = 0; b < env->boards; b++) FreeGameState(&env->states[b]);
+    }
+    free(env->states);
+    free(env->levels);
+    free(env->angles);
+    free(env->attached);
+    free(env->remaining);
+    free(env->outcome);
+    free(pool);
+    memset(env, 0, sizeof(*env));
+}
+
+void ResetBatchEnv(BatchEnv *env) {
+    for (int b = 0; b < env->boards; b++) {
+        StartLevel(&env->states[b], env->levels[b]);
+        env->outcome[b] = BATCH_RUNNING;
+        Observe(env, b);
+    }
+}
+
+void StepBatchEnv(BatchEnv *env, const uint8_t *actions) {
+    BatchPool *pool = env->pool;
+    if (env->threads > 1) {
+        pthread_mutex_lock(&pool->lock);
+        pool->actions = actions;
+        pool->pending = env->threads - 1;
+        pool->generation++;
+        pthread_cond_broadcast(&pool->start);
+        pthread_mutex_unlock(&pool->lock);
+    }
+
+    StepSlice(&pool->workers[0], actions);
+
+    if (env->threads > 1) {
+        pthread_mutex_lock(&pool->lock);
+        while (pool->pending > 0) pthread_cond_wait(&pool->done, &pool->lock);
+        pthread_mutex_unlock(&pool->lock);
+    }
+
+    long episodes = 0;
+    for (int t = 0; t < env->threads; t++) episodes += pool->workers[t].episodes;
+    env->episodes = episodes;
+}
@@ -0,0 +1,56 @@
+#ifndef BATCH_ENV_H
+#define BATCH_ENV_H
+
+#include "game.h"
+#include <stdint.h>
+
+// Many independent boards stepped together, for training and evaluating
+// autoplay bots without a window. Every step takes one launch/no-launch
+// action per board and fills contiguous buffers with what a bot sees. The
+// boards are split into contiguous slices, one per thread; the calling
+// thread steps the first slice.
+//
+// An episode is one attempt at a level. It ends when the level is passed
+// or on the first collision, and the board starts the level again at once,
+// so after a terminal step the observation is already of the new attempt.
+
+// Attached pins reported per board; a level with more pins collides first
+#define BATCH_OBS_PINS (MAX_OBSTACLES + MAX_RING_PINS + 1)
+#define BATCH_MAX_THREADS 64
+
+typedef enum {
+    BATCH_RUNNING,
+    BATCH_PASSED,
+    BATCH_FAILED,
+} BatchOutcome;
+
+typedef struct BatchPool BatchPool;
+
+typedef struct {
+    int boards;
+    int threads;
+    GameState *states;
+    int *levels;
+
+    // Observations after the latest step, board b at [b] or, for angles,
+    // [b * BATCH_OBS_PINS, b * BATCH_OBS_PINS + attached[b])
+    BinaryAngle *angles;    // attached pins; a pin is launched at LAUNCH_ANGLE
+    int *attached;
+    int *remaining;         // pins still to launch, level_pin - count
+    uint8_t *outcome;       // BatchOutcome of the step
+    long episodes;          // finished since the batch was created
+
+    BatchPool *pool;
+} BatchEnv;
+
+// Board b plays level firstLevel + b % levelCount. threads is clamped to
+// [1, BATCH_MAX_THREADS] and to the number of boards.
+bool InitBatchEnv(BatchEnv *env, int boards, int firstLevel, int levelCount, int threads);
+void FreeBatchEnv(BatchEnv *env);
+
+// Starts every board's level again and fills the observations
+void ResetBatchEnv(BatchEnv *env);
+// Steps every board once. actions[b] is nonzero to launch on board b.
+void StepBatchEnv(BatchEnv *env, const uint8_t *actions);
+
+#endif
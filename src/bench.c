@@ -0,0 +1,164 @@
+// Headless frame-throughput benchmark for the game simulation.
+//
+//   cc -O2 -o aa_bench src/bench.c src/game.c src/angle_index.c src/level_pack.c src/mapped_file.c -lm
+//   ./aa_bench [levels] [frames per level]
+//   ./aa_bench --endless [pins]
+//
+// A scripted player launches pins at pseudo-random intervals. Every level
+// from 1 up to the given count is stepped for the requested number of
+// frames, restarting whenever the level is passed or failed.
+//
+// With --endless, an autoplayer plays endless mode until the board holds
+// the given number of pins and reports the step time for every thousand
+// pins on the board.
+
+#define _POSIX_C_SOURCE 199309L
+#include "game.h"
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#define ENDLESS_BUCKET 1000
+// The autoplayer gives up on a stage after this many steps without a safe
+// launch
+#define ENDLESS_MAX_WAIT (10 * SIM_HZ)
+
+static double Now(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+static unsigned int NextRandom(unsigned int *seed) {
+    *seed ^= *seed << 13;
+    *seed ^= *seed >> 17;
+    *seed ^= *seed << 5;
+    return *seed;
+}
+
+// Steps from launch until a pin attaches, as GameUpdate() moves it
+static int AttachSteps(void) {
+    float y = PIN_LAUNCH_OFFSET;
+    int steps = 0;
+    do {
+        y -= PIN_SPEED;
+        steps++;
+    } while (y > ATTACH_RADIUS);
+    return steps;
+}
+
+// Launches only when nothing is in flight and the pin would attach clear of
+// the inner ring. The attach angle is predicted by accumulating the board
+// rotation exactly as GameUpdate() does.
+static bool SafeToLaunch(const GameState *state, int attachSteps) {
+    if (state->pins.attachedCount != state->pins.count) return false;
+    if (state->pins.count >= state->level_pin) return false;
+
+    BinaryAngle boardAngle = state->boardAngle;
+    for (int s = 1; s <= attachSteps; s++) {
+        boardAngle += DegreesToAngle(LevelRotationStep(&state->levelRecord, state->tick + s));
+    }
+    int hits[2];
+    BinaryAngle rel = BoardRelativeAngle(boardAngle, LAUNCH_ANGLE);
+    return AngleIndexFindNear(&state->attachedIndex, rel, COLLISION_ANGLE + DegreesToAngle(1.0), hits) == 0;
+}
+
+static int RunEndless(int targetPins) {
+    static GameState state;
+    InitGameState(&state);
+    StartEndless(&state);
+
+    int buckets = targetPins / ENDLESS_BUCKET + 1;
+    double *bucketTime = calloc(buckets, sizeof(double));
+    long *bucketSteps = calloc(buckets, sizeof(long));
+    int attachSteps = AttachSteps();
+    long waited = 0;
+    bool failed = false;
+
+    double start = Now();
+    while (state.pins.count < targetPins) {
+        GameInput input = { .launch = SafeToLaunch(&state, attachSteps) || waited > ENDLESS_MAX_WAIT };
+        waited = input.launch ? 0 : waited + 1;
+
+        int bucket = state.pins.count / ENDLESS_BUCKET;
+        double stepStart = Now();
+        int events = GameUpdate(&state, input);
+        bucketTime[bucket] += Now() - stepStart;
+        bucketSteps[bucket]++;
+        if (events & (GAME_EVENT_COLLISION | GAME_EVENT_FAIL)) {
+            failed = true;
+            break;
+        }
+    }
+    double elapsed = Now() - start;
+
+    printf("%12s %10s %10s\n", "pins", "steps", "ns/step");
+    for (int b = 0; b < buckets; b++) {
+        if (bucketSteps[b] == 0) continue;
+        printf("%5d-%-6d %10ld %10.1f\n", b * ENDLESS_BUCKET, (b + 1) * ENDLESS_BUCKET - 1, bucketSteps[b],
+               bucketTime[b] * 1e9 / bucketSteps[b]);
+    }
+    printf("endless: %d pins on %d rings after %d stages, %ld steps in %.3f s%s\n", state.pins.count,
+           state.rings + 1, state.stage, state.tick, elapsed, failed ? " (collided)" : "");
+
+    free(bucketTime);
+    free(bucketSteps);
+    FreeGameState(&state);
+    return failed ? 1 : 0;
+}
+
+int main(int argc, char **argv) {
+    if (argc > 1 && strcmp(argv[1], "--endless") == 0) {
+        int pins = (argc > 2) ? atoi(argv[2]) : 10000;
+        return RunEndless(pins < 1 ? 1 : pins);
+    }
+
+    int levels = (argc > 1) ? atoi(argv[1]) : 40;
+    long framesPerLevel = (argc > 2) ? atol(argv[2]) : 100000;
+    if (levels < 1) levels = 1;
+    if (framesPerLevel < 1) framesPerLevel = 1;
+
+    static GameState state;
+    InitGameState(&state);
+
+    long totalFrames = 0;
+    long checksum = 0;
+    double totalTime = 0;
+
+    printf("%6s %10s %8s %8s %12s %10s\n", "level", "frames", "passed", "failed", "frames/sec", "ns/frame");
+    for (int level = 1; level <= levels; level++) {
+        unsigned int seed = 0x9E3779B9u ^ (unsigned int)level;
+        int passed = 0, failed = 0;
+        int nextLaunch = 0;
+
+        StartLevel(&state, level);
+        double start = Now();
+        for (long frame = 0; frame < framesPerLevel; frame++) {
+            GameInput input = { .launch = (nextLaunch-- <= 0) };
+            if (input.launch) nextLaunch = 8 + NextRandom(&seed) % 32;
+
+            int events = GameUpdate(&state, input);
+            if (events & GAME_EVENT_LEVEL_PASSED) {
+                passed++;
+                StartLevel(&state, level);
+            } else if (events & GAME_EVENT_FAIL) {
+                failed++;
+                StartLevel(&state, level);
+            }
+            checksum += state.pins.count;
+        }
+        double elapsed = Now() - start;
+
+        totalFrames += framesPerLevel;
+        totalTime += elapsed;
+        printf("%6d %10ld %8d %8d %12.0f %10.1f\n", level, framesPerLevel, passed, failed,
+               framesPerLevel / elapsed, elapsed * 1e9 / framesPerLevel);
+    }
+
+    printf("total: %ld frames in %.3f s, %.0f frames/sec, %.1f ns/frame (checksum %ld)\n",
+           totalFrames, totalTime, totalFrames / totalTime, totalTime * 1e9 / totalFrames, checksum);
+    FreeGameState(&state);
+    return 0;
+}
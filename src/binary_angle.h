@@ -0,0 +1,33 @@
+#ifndef BINARY_ANGLE_H
+#define BINARY_ANGLE_H
+
+#include <math.h>
+#include <stdint.h>
+
+// Angles in binary angle units: a full turn is 2^32, so adding and
+// subtracting wrap around the circle through unsigned overflow, in either
+// direction, and give the same bits on every compiler and machine. Degrees
+// are only used at the edges, for level data and display.
+typedef uint32_t BinaryAngle;
+
+#define BINARY_ANGLE_TURN 4294967296.0
+#define BINARY_ANGLE_QUARTER 0x40000000u
+
+// Nearest binary angle to any number of degrees, negative ones included
+static inline BinaryAngle DegreesToAngle(double degrees) {
+    return (BinaryAngle)(int64_t)floor(degrees * (BINARY_ANGLE_TURN / 360.0) + 0.5);
+}
+
+static inline float AngleToDegrees(BinaryAngle angle) {
+    return (float)(angle * (360.0 / BINARY_ANGLE_TURN));
+}
+
+// True when a and b are less than threshold apart either way round. One
+// subtract and one unsigned compare: a - b lands in (-threshold, threshold)
+// exactly when shifting it up by threshold - 1 leaves it below
+// 2 * threshold - 1. threshold must be at most half a turn.
+static inline int AnglesWithin(BinaryAngle a, BinaryAngle b, BinaryAngle threshold) {
+    return (BinaryAngle)(a - b + threshold - 1) < 2 * threshold - 1;
+}
+
+#endif
@@ -0,0 +1,203 @@
+#include "effects.h"
+#include "pin_render.h"
+#include "rlgl.h"
+
+#define BURST_PARTICLES 12
+#define SPARK_PARTICLES 24
+#define PULSE_SEGMENTS 48
+#define PULSE_DURATION 0.7f
+
+// Particles as separate arrays. A particle that dies is replaced by the
+// last one, so the live particles are always [0, count).
+typedef struct {
+    float x[EFFECT_PARTICLE_CAPACITY];
+    float y[EFFECT_PARTICLE_CAPACITY];
+    float vx[EFFECT_PARTICLE_CAPACITY];
+    float vy[EFFECT_PARTICLE_CAPACITY];
+    float life[EFFECT_PARTICLE_CAPACITY];       // seconds left
+    float duration[EFFECT_PARTICLE_CAPACITY];
+    Color color[EFFECT_PARTICLE_CAPACITY];
+    int count;
+} ParticlePool;
+
+typedef struct {
+    Vector2 center[EFFECT_PULSE_CAPACITY];
+    float radius[EFFECT_PULSE_CAPACITY];
+    float age[EFFECT_PULSE_CAPACITY];
+    Color color[EFFECT_PULSE_CAPACITY];
+    int count;
+} PulsePool;
+
+static ParticlePool bursts;
+static ParticlePool sparks;
+static PulsePool pulses;
+static int budget = EFFECT_FRAME_BUDGET;
+static unsigned int seed = 0x2545F491u;
+
+static float RandomUnit(void) {
+    seed ^= seed << 13;
+    seed ^= seed >> 17;
+    seed ^= seed << 5;
+    return (seed >> 8) * (1.0f / 16777216.0f);
+}
+
+void InitEffects(void) {
+    ClearEffects();
+}
+
+void ClearEffects(void) {
+    bursts.count = 0;
+    sparks.count = 0;
+    pulses.count = 0;
+}
+
+// Spawns up to count particles flying out of position, as many as the
+// pool and the frame budget allow
+static void Emit(ParticlePool *pool, int count, Vector2 position, float speed, float duration, Color color) {
+    if (count > budget) count = budget;
+    if (count > EFFECT_PARTICLE_CAPACITY - pool->count) count = EFFECT_PARTICLE_CAPACITY - pool->count;
+    budget -= count;
+
+    for (int n = 0; n < count; n++) {
+        int i = pool->count++;
+        Vector2 dir = AngleDirection(DegreesToAngle(RandomUnit() * 360.0f));
+        float v = speed * (0.5f + RandomUnit());
+        pool->x[i] = position.x;
+        pool->y[i] = position.y;
+        pool->vx[i] = dir.x * v;
+        pool->vy[i] = dir.y * v;
+        pool->duration[i] = duration * (0.6f + 0.4f * RandomUnit());
+        pool->life[i] = pool->duration[i];
+        pool->color[i] = color;
+    }
+}
+
+void SpawnAttachBurst(Vector2 position, Color color) {
+    Emit(&bursts, BURST_PARTICLES, position, 90.0f, 0.45f, color);
+}
+
+void SpawnCollisionSparks(Vector2 position) {
+    Emit(&sparks, SPARK_PARTICLES, position, 320.0f, 0.6f, (Color){ 255, 200, 40, 255 });
+}
+
+void SpawnPassPulse(Vector2 center, float radius, Color color) {
+    if (pulses.count == EFFECT_PULSE_CAPACITY) return;
+    int i = pulses.count++;
+    pulses.center[i] = center;
+    pulses.radius[i] = radius;
+    pulses.age[i] = 0.0f;
+    pulses.color[i] = color;
+}
+
+static void UpdatePool(ParticlePool *pool, float dt, float drag) {
+    float keep = 1.0f - drag * dt;
+    if (keep < 0.0f) keep = 0.0f;
+    int i = 0;
+    while (i < pool->count) {
+        pool->life[i] -= dt;
+        if (pool->life[i] <= 0.0f) {
+            int last = --pool->count;
+            pool->x[i] = pool->x[last];
+            pool->y[i] = pool->y[last];
+            pool->vx[i] = pool->vx[last];
+            pool->vy[i] = pool->vy[last];
+            pool->life[i] = pool->life[last];
+            pool->duration[i] = pool->duration[last];
+            pool->color[i] = pool->color[last];
+            continue;
+        }
+        pool->x[i] += pool->vx[i] * dt;
+        pool->y[i] += pool->vy[i] * dt;
+        pool->vx[i] *= keep;
+        pool->vy[i] *= keep;
+        i++;
+    }
+}
+
+void UpdateEffects(float dt) {
+    budget = EFFECT_FRAME_BUDGET;
+    UpdatePool(&bursts, dt, 4.0f);
+    UpdatePool(&sparks, dt, 2.0f);
+
+    int i = 0;
+    while (i < pulses.count) {
+        pulses.age[i] += dt;
+        if (pulses.age[i] >= PULSE_DURATION) {
+            int last = --pulses.count;
+            pulses.center[i] = pulses.center[last];
+            pulses.radius[i] = pulses.radius[last];
+            pulses.age[i] = pulses.age[last];
+            pulses.color[i] = pulses.color[last];
+            continue;
+        }
+        i++;
+    }
+}
+
+static void DrawBursts(void) {
+    if (bursts.count == 0) return;
+    rlCheckRenderBatchLimit(6 * bursts.count);
+    rlBegin(RL_TRIANGLES);
+    for (int i = 0; i < bursts.count; i++) {
+        float t = bursts.life[i] / bursts.duration[i];
+        float s = 1.0f + 3.0f * t;
+        float x = bursts.x[i], y = bursts.y[i];
+        Color c = bursts.color[i];
+        rlColor4ub(c.r, c.g, c.b, (unsigned char)(c.a * t));
+        rlVertex2f(x - s, y - s); rlVertex2f(x - s, y + s); rlVertex2f(x + s, y + s);
+        rlVertex2f(x - s, y - s); rlVertex2f(x + s, y + s); rlVertex2f(x + s, y - s);
+    }
+    rlEnd();
+}
+
+static void DrawSparks(void) {
+    if (sparks.count == 0) return;
+    rlCheckRenderBatchLimit(2 * sparks.count);
+    rlBegin(RL_LINES);
+    for (int i = 0; i < sparks.count; i++) {
+        float t = sparks.life[i] / sparks.duration[i];
+        Color c = sparks.color[i];
+        rlColor4ub(c.r, c.g, c.b, (unsigned char)(c.a * t));
+        // Streaks are as long as the distance covered in 30 ms
+        rlVertex2f(sparks.x[i], sparks.y[i]);
+        rlVertex2f(sparks.x[i] - sparks.vx[i] * 0.03f, sparks.y[i] - sparks.vy[i] * 0.03f);
+    }
+    rlEnd();
+}
+
+static void DrawPulses(void) {
+    if (pulses.count == 0) return;
+    rlCheckRenderBatchLimit(6 * PULSE_SEGMENTS * pulses.count);
+    rlBegin(RL_TRIANGLES);
+    for (int i = 0; i < pulses.count; i++) {
+        float t = pulses.age[i] / PULSE_DURATION;
+        float inner = pulses.radius[i] * (1.0f + 0.6f * t);
+        float outer = inner + 10.0f * (1.0f - t) + 1.0f;
+        Vector2 c = pulses.center[i];
+        Color col = pulses.color[i];
+        rlColor4ub(col.r, col.g, col.b, (unsigned char)(col.a * (1.0f - t)));
+
+        Vector2 a = AngleDirection(0);
+        for (int s = 1; s <= PULSE_SEGMENTS; s++) {
+            Vector2 b = AngleDirection(DegreesToAngle(s * (360.0 / PULSE_SEGMENTS)));
+            rlVertex2f(c.x + a.x * inner, c.y + a.y * inner);
+            rlVertex2f(c.x + b.x * inner, c.y + b.y * inner);
+            rlVertex2f(c.x + a.x * outer, c.y + a.y * outer);
+            rlVertex2f(c.x + b.x * inner, c.y + b.y * inner);
+            rlVertex2f(c.x + b.x * outer, c.y + b.y * outer);
+            rlVertex2f(c.x + a.x * outer, c.y + a.y * outer);
+            a = b;
+        }
+    }
+    rlEnd();
+}
+
+void DrawEffects(void) {
+    DrawPulses();
+    DrawBursts();
+    DrawSparks();
+}
+
+int GetEffectCount(void) {
+    return bursts.count + sparks.count + pulses.count;
+}
@@ -0,0 +1,30 @@
+#ifndef EFFECTS_H
+#define EFFECTS_H
+
+#include "raylib.h"
+
+// Particle effects for attaches, collisions and passed levels. Every
+// effect type has a fixed pool allocated up front and is drawn in a single
+// batch. At most EFFECT_FRAME_BUDGET particles are spawned per frame;
+// spawns beyond the budget or a full pool are dropped.
+#define EFFECT_PARTICLE_CAPACITY 512     // per particle type
+#define EFFECT_PULSE_CAPACITY 8
+#define EFFECT_FRAME_BUDGET 128
+
+void InitEffects(void);
+void ClearEffects(void);
+
+// A burst of dots where a pin attached
+void SpawnAttachBurst(Vector2 position, Color color);
+// Sparks flying out from a collision
+void SpawnCollisionSparks(Vector2 position);
+// A ring that grows out from center
+void SpawnPassPulse(Vector2 center, float radius, Color color);
+
+// Advances every effect by dt seconds and starts a new frame budget
+void UpdateEffects(float dt);
+void DrawEffects(void);
+// Particles currently alive, all types together
+int GetEffectCount(void);
+
+#endif
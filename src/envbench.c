@@ -0,0 +1,74 @@
+// Throughput of the batch environment.
+//
+//   cc -O2 -pthread -o aa_envbench src/envbench.c src/batch_env.c src/game.c src/angle_index.c src/level_pack.c src/mapped_file.c -lm
+//   ./aa_envbench [boards] [steps] [threads]
+//
+// Steps a batch of boards playing levels 1..40 with a random policy, first
+// on one thread and then on the given number, and reports board steps per
+// second in total and per thread.
+
+#define _POSIX_C_SOURCE 200809L
+#include "batch_env.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include <unistd.h>
+
+static double Now(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+static unsigned int NextRandom(unsigned int *seed) {
+    *seed ^= *seed << 13;
+    *seed ^= *seed >> 17;
+    *seed ^= *seed << 5;
+    return *seed;
+}
+
+// Returns board steps per second
+static double Run(int boards, long steps, int threads) {
+    BatchEnv env;
+    if (!InitBatchEnv(&env, boards, 1, 40, threads)) {
+        fprintf(stderr, "could not create %d boards\n", boards);
+        exit(1);
+    }
+    uint8_t *actions = malloc(boards);
+    unsigned int seed = 0x9E3779B9u;
+    long passed = 0;
+
+    double start = Now();
+    for (long s = 0; s < steps; s++) {
+        // About one launch every 16 steps per board
+        for (int b = 0; b < boards; b++) actions[b] = (NextRandom(&seed) & 15) == 0 && env.remaining[b] > 0;
+        StepBatchEnv(&env, actions);
+        for (int b = 0; b < boards; b++) passed += env.outcome[b] == BATCH_PASSED;
+    }
+    double elapsed = Now() - start;
+
+    double rate = boards * (double)steps / elapsed;
+    printf("%7d %7d %10ld %9ld %8ld %14.0f %14.0f\n", env.threads, boards, steps, env.episodes, passed,
+           rate, rate / env.threads);
+    free(actions);
+    FreeBatchEnv(&env);
+    return rate;
+}
+
+int main(int argc, char **argv) {
+    int boards = (argc > 1) ? atoi(argv[1]) : 4096;
+    long steps = (argc > 2) ? atol(argv[2]) : 2000;
+    int threads = (argc > 3) ? atoi(argv[3]) : (int)sysconf(_SC_NPROCESSORS_ONLN);
+    if (boards < 1) boards = 1;
+    if (steps < 1) steps = 1;
+    if (threads < 1) threads = 1;
+
+    printf("%7s %7s %10s %9s %8s %14s %14s\n", "threads", "boards", "steps", "episodes", "passed",
+           "steps/sec", "per thread");
+    double single = Run(boards, steps, 1);
+    if (threads > 1) {
+        double multi = Run(boards, steps, threads);
+        printf("%.2fx on %d threads\n", multi / single, threads);
+    }
+    return 0;
+}
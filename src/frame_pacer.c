@@ -0,0 +1,180 @@
+#define _POSIX_C_SOURCE 199309L
+#include "frame_pacer.h"
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+// Sleeping stops spinMargin before a deadline and the rest is spun. The
+// margin follows the worst oversleep seen: up at once, back down slowly.
+#define SPIN_MARGIN_MIN 0.0005
+#define SPIN_MARGIN_MAX 0.004
+#define SPIN_MARGIN_SLACK 0.00025
+// Adaptive mode goes back to a faster rate once this many frames in a row
+// have fit it with a quarter to spare
+#define ADAPTIVE_SETTLE_FRAMES 120
+#define ADAPTIVE_MAX_DIVISOR 4
+
+static PacingMode mode = PACING_VSYNC;
+static double capHz = 60.0;
+static double displayHz = 60.0;
+static int divisor = 1;             // adaptive: blanks per frame
+static int settled = 0;
+static double deadline = 0.0;       // fixed: 0 until the first frame
+static double spinMargin = 0.002;
+static double lastPresent = 0.0;
+static double workStart = 0.0;
+static double averageInterval = 0.0;
+
+static float errors[PACING_SAMPLES];
+static int errorCount = 0;
+static int errorNext = 0;
+
+static const char *modeNames[PACING_MODE_COUNT] = { "vsync", "uncapped", "fixed", "adaptive" };
+
+static double Now(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+static void WaitUntil(double t) {
+    double now = Now();
+    if (t - now > spinMargin) {
+        double wake = t - spinMargin;
+        double seconds = wake - now;
+        struct timespec ts = { (time_t)seconds, (long)((seconds - (time_t)seconds) * 1e9) };
+        nanosleep(&ts, NULL);
+
+        double oversleep = Now() - wake;
+        if (oversleep + SPIN_MARGIN_SLACK > spinMargin) {
+            spinMargin = oversleep + SPIN_MARGIN_SLACK;
+        } else {
+            spinMargin -= (spinMargin - SPIN_MARGIN_MIN) * 0.01;
+        }
+        if (spinMargin > SPIN_MARGIN_MAX) spinMargin = SPIN_MARGIN_MAX;
+        if (spinMargin < SPIN_MARGIN_MIN) spinMargin = SPIN_MARGIN_MIN;
+    }
+    while (Now() < t) {
+    }
+}
+
+static double TargetPeriod(void) {
+    switch (mode) {
+        case PACING_VSYNC: return 1.0 / displayHz;
+        case PACING_FIXED: return 1.0 / capHz;
+        case PACING_ADAPTIVE: return divisor / displayHz;
+        default: return 0.0;
+    }
+}
+
+void SetFramePacing(PacingMode newMode, double newCapHz, double newDisplayHz) {
+    mode = (newMode >= 0 && newMode < PACING_MODE_COUNT) ? newMode : PACING_VSYNC;
+    displayHz = newDisplayHz > 0 ? newDisplayHz : 60.0;
+    capHz = newCapHz > 0 ? newCapHz : displayHz;
+    divisor = 1;
+    settled = 0;
+    deadline = 0.0;
+    lastPresent = 0.0;
+    averageInterval = 0.0;
+    errorCount = 0;
+    errorNext = 0;
+}
+
+PacingMode GetPacingMode(void) {
+    return mode;
+}
+
+bool PacingUsesVsync(PacingMode m) {
+    return m == PACING_VSYNC || m == PACING_ADAPTIVE;
+}
+
+const char *PacingModeName(PacingMode m) {
+    return (m >= 0 && m < PACING_MODE_COUNT) ? modeNames[m] : "?";
+}
+
+bool ParsePacingMode(const char *text, PacingMode *m, double *hz) {
+    for (int i = 0; i < PACING_MODE_COUNT; i++) {
+        if (i != PACING_FIXED && strcmp(text, modeNames[i]) == 0) {
+            *m = (PacingMode)i;
+            return true;
+        }
+    }
+    char *end;
+    double rate = strtod(text, &end);
+    if (end == text || *end != '\0' || !(rate > 0)) return false;
+    *m = PACING_FIXED;
+    *hz = rate;
+    return true;
+}
+
+// Drops to every next blank as soon as a frame's work overruns the time
+// it has, so frames stay evenly spaced instead of alternating
+static void AdaptRate(double work) {
+    double refresh = 1.0 / displayHz;
+    if (work > divisor * refresh * 0.9 && divisor < ADAPTIVE_MAX_DIVISOR) {
+        divisor++;
+        settled = 0;
+    } else if (divisor > 1 && work < (divisor - 1) * refresh * 0.75) {
+        if (++settled >= ADAPTIVE_SETTLE_FRAMES) {
+            divisor--;
+            settled = 0;
+        }
+    } else {
+        settled = 0;
+    }
+}
+
+void PaceFrame(void) {
+    double now = Now();
+    if (mode == PACING_FIXED) {
+        // Deadlines follow on from each other, so wakeup error does not
+        // build up; a missed one restarts the schedule from now
+        double period = 1.0 / capHz;
+        deadline = deadline > 0 ? deadline + period : now;
+        if (deadline < now) deadline = now;
+        WaitUntil(deadline);
+    } else if (mode == PACING_ADAPTIVE && workStart > 0) {
+        AdaptRate(now - workStart);
+        // The last present returned at a blank. Waking half a refresh
+        // before the one aimed for leaves the swap to wait for it.
+        if (divisor > 1) WaitUntil(lastPresent + (divisor - 0.5) / displayHz);
+    }
+}
+
+void FramePresented(bool waited) {
+    double now = Now();
+    if (lastPresent > 0 && !waited) {
+        double interval = now - lastPresent;
+        averageInterval = averageInterval > 0 ? averageInterval + (interval - averageInterval) / 32 : interval;
+        double target = mode == PACING_UNCAPPED ? averageInterval : TargetPeriod();
+        errors[errorNext] = (float)(fabs(interval - target) * 1000.0);
+        errorNext = (errorNext + 1) % PACING_SAMPLES;
+        if (errorCount < PACING_SAMPLES) errorCount++;
+    }
+    if (waited) deadline = 0.0;
+    lastPresent = now;
+    workStart = now;
+}
+
+static int CompareFloat(const void *a, const void *b) {
+    float x = *(const float *)a, y = *(const float *)b;
+    return (x > y) - (x < y);
+}
+
+void GetPacingStats(PacingStats *stats) {
+    memset(stats, 0, sizeof(*stats));
+    stats->target = (float)(TargetPeriod() * 1000.0);
+    stats->count = errorCount;
+    if (errorCount == 0) return;
+
+    float sorted[PACING_SAMPLES];
+    memcpy(sorted, errors, errorCount * sizeof(float));
+    qsort(sorted, errorCount, sizeof(float), CompareFloat);
+
+    double sum = 0.0;
+    for (int i = 0; i < errorCount; i++) sum += sorted[i];
+    stats->average = (float)(sum / errorCount);
+    stats->p99 = sorted[(errorCount * 99 + 99) / 100 - 1];
+    stats->max = sorted[errorCount - 1];
+}
@@ -0,0 +1,52 @@
+#ifndef FRAME_PACER_H
+#define FRAME_PACER_H
+
+#include <stdbool.h>
+
+#define PACING_SAMPLES 256
+
+// How frames are presented:
+//   PACING_VSYNC     the swap waits for every vertical blank
+//   PACING_UNCAPPED  no vsync and no limit
+//   PACING_FIXED     no vsync, frames are held to capHz by the limiter
+//   PACING_ADAPTIVE  vsync, and when frames stop fitting in a refresh the
+//                    limiter holds them to every second (third, fourth)
+//                    blank instead of letting them alternate
+typedef enum {
+    PACING_VSYNC,
+    PACING_UNCAPPED,
+    PACING_FIXED,
+    PACING_ADAPTIVE,
+    PACING_MODE_COUNT
+} PacingMode;
+
+// displayHz is the monitor refresh rate, 60 when 0 or less. capHz is the
+// rate for PACING_FIXED, the refresh rate when 0 or less.
+void SetFramePacing(PacingMode mode, double capHz, double displayHz);
+PacingMode GetPacingMode(void);
+bool PacingUsesVsync(PacingMode mode);
+const char *PacingModeName(PacingMode mode);
+// "vsync", "uncapped", "adaptive", or a rate in Hz for a fixed cap
+bool ParsePacingMode(const char *text, PacingMode *mode, double *capHz);
+
+// Call right before presenting. Waits for the frame's deadline when the
+// limiter is active: sleeps until shortly before it and spins the rest.
+void PaceFrame(void);
+// Call right after presenting. waited is set when presenting blocked on
+// input events, so the interval says nothing about pacing.
+void FramePresented(bool waited);
+
+// Pacing error, in ms: how far each interval between presents was from
+// the target period. Uncapped frames have no target and are compared with
+// the average interval instead.
+typedef struct {
+    float average;
+    float p99;
+    float max;
+    float target;   // ms between presents aimed for, 0 when uncapped
+    int count;      // samples kept, at most PACING_SAMPLES
+} PacingStats;
+
+void GetPacingStats(PacingStats *stats);
+
+#endif
@@ -0,0 +1,284 @@
+#include "game.h"
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+#if defined(__AVX2__)
+    #include <immintrin.h>
+#elif defined(__SSE2__) || defined(_M_X64)
+    #include <emmintrin.h>
+    #define PIN_SSE2
+#endif
+
+// The game and tools built with AA_PROFILE time the simulation phases
+#if defined(AA_PROFILE)
+    #include "profiler.h"
+    #define SIM_BEGIN(phase) PROFILE_BEGIN(phase)
+    #define SIM_END(phase) PROFILE_END(phase)
+#else
+    #define SIM_BEGIN(phase)
+    #define SIM_END(phase)
+#endif
+
+// The index only holds the inner ring: obstacles, the pins that fit
+// without touching and the one that collided
+_Static_assert(MAX_OBSTACLES + MAX_RING_PINS + 1 <= ANGLE_INDEX_CAPACITY, "angle index too small for a ring");
+_Static_assert(PIN_LAUNCH_OFFSET_PX - GAME_MAX_LAUNCH_LAG * PIN_SPEED_PX > ATTACH_RADIUS,
+               "a lagged launch could miss its attach step");
+_Static_assert(sizeof(BinaryAngle) == sizeof(float), "pin arrays are laid out with one stride");
+
+// Turns attached pins by step. Angles wrap through integer overflow, so
+// the vector paths and the scalar tail are plain adds and agree bit for bit.
+static void RotatePins(BinaryAngle *angles, int count, BinaryAngle step) {
+    int i = 0;
+#if defined(__AVX2__)
+    __m256i step8 = _mm256_set1_epi32((int)step);
+    for (; i + 8 <= count; i += 8) {
+        __m256i a = _mm256_loadu_si256((const __m256i *)(angles + i));
+        _mm256_storeu_si256((__m256i *)(angles + i), _mm256_add_epi32(a, step8));
+    }
+#elif defined(PIN_SSE2)
+    __m128i step4 = _mm_set1_epi32((int)step);
+    for (; i + 4 <= count; i += 4) {
+        __m128i a = _mm_loadu_si128((const __m128i *)(angles + i));
+        _mm_storeu_si128((__m128i *)(angles + i), _mm_add_epi32(a, step4));
+    }
+#endif
+    for (; i < count; i++) {
+        angles[i] += step;
+    }
+}
+
+bool ReservePins(PinSet *pins, int capacity) {
+    if (capacity <= pins->capacity) return true;
+
+    int grown = pins->capacity > 0 ? pins->capacity : 256;
+    while (grown < capacity) grown *= 2;
+    size_t floats = (size_t)grown * sizeof(float);
+    unsigned char *block = malloc(2 * floats + grown * sizeof(bool));
+    if (!block) return false;
+
+    BinaryAngle *angle = (BinaryAngle *)block;
+    float *yOffset = (float *)(block + floats);
+    bool *collided = (bool *)(block + 2 * floats);
+    if (pins->count > 0) {
+        memcpy(angle, pins->angle, pins->count * sizeof(BinaryAngle));
+        memcpy(yOffset, pins->yOffset, pins->count * sizeof(float));
+        memcpy(collided, pins->collided, pins->count * sizeof(bool));
+    }
+    free(pins->block);
+    pins->block = block;
+    pins->angle = angle;
+    pins->yOffset = yOffset;
+    pins->collided = collided;
+    pins->capacity = grown;
+    return true;
+}
+
+void FreePins(PinSet *pins) {
+    free(pins->block);
+    memset(pins, 0, sizeof(*pins));
+}
+
+void CopyPins(PinSet *dst, const PinSet *src) {
+    int count = src->count;
+    if (!ReservePins(dst, count)) count = dst->capacity;
+    if (count > 0) {
+        memcpy(dst->angle, src->angle, count * sizeof(BinaryAngle));
+        memcpy(dst->yOffset, src->yOffset, count * sizeof(float));
+        memcpy(dst->collided, src->collided, count * sizeof(bool));
+    }
+    dst->count = count;
+    dst->attachedCount = src->attachedCount < count ? src->attachedCount : count;
+}
+
+// A pin has just reached the attach radius. Attached pins never move
+// relative to each other, so this is the only moment a collision can start.
+static int AttachPin(GameState *state, int i) {
+    PinSet *pins = &state->pins;
+    SIM_BEGIN(PROFILE_COLLISION);
+    BinaryAngle rel = BoardRelativeAngle(state->boardAngle, pins->angle[i]);
+    int hits[2];
+    int found = AngleIndexFindNear(&state->attachedIndex, rel, COLLISION_ANGLE, hits);
+
+    AngleIndexInsert(&state->attachedIndex, rel, i);
+    SIM_END(PROFILE_COLLISION);
+    if (found == 0) return GAME_EVENT_NONE;
+
+    pins->collided[i] = true;
+    for (int h = 0; h < found; h++) {
+        pins->collided[hits[h]] = true;
+    }
+    if (!state->gameOver) {
+        state->collidedA = (found == 2 && hits[1] < hits[0]) ? hits[1] : hits[0];
+        state->collidedB = i;
+    }
+    state->gameOver = true;
+    state->failTriggered = true;
+    state->failTimer = 0.0f;
+    return GAME_EVENT_COLLISION;
+}
+
+void InitGameState(GameState *state) {
+    memset(state, 0, sizeof(*state));
+    state->current_level = 1;
+    state->rotationTimer = 1;
+    state->collidedA = -1;
+    state->collidedB = -1;
+    ReservePins(&state->pins, 256);
+}
+
+void FreeGameState(GameState *state) {
+    FreePins(&state->pins);
+}
+
+void ResetGame(GameState *state) {
+    state->pins.count = 0;
+    state->pins.attachedCount = 0;
+    state->gameOver = false;
+    state->collidedA = -1;
+    state->collidedB = -1;
+    state->boardAngle = 0;
+    // Restart the rotation phase so a level plays the same on every attempt
+    state->tick = 0;
+    state->stageStartTick = 0;
+    state->rotationTimer = 1;
+    AngleIndexClear(&state->attachedIndex);
+    state->endless = false;
+    state->stage = 0;
+    state->rings = 0;
+    state->ringStart = 0;
+}
+
+static const LevelPack *levelPack = NULL;
+
+void SetLevelPack(const LevelPack *pack) {
+    levelPack = pack;
+}
+
+// Loads a level's record and adds its obstacles to the inner ring. The
+// level is done once its other pins have been launched on top of the
+// pins already on the board.
+static void AddLevel(GameState *state, int level) {
+    const LevelRecord *record = levelPack ? GetPackLevel(levelPack, level) : NULL;
+    if (record) {
+        state->levelRecord = *record;
+    } else {
+        BuiltinLevel(level, &state->levelRecord);
+    }
+
+    LevelRecord *def = &state->levelRecord;
+    int obstacle_pin = def->obstacleCount;
+    if (obstacle_pin > MAX_OBSTACLES) obstacle_pin = MAX_OBSTACLES;
+    if (obstacle_pin > def->level_pin) obstacle_pin = def->level_pin;
+
+    PinSet *pins = &state->pins;
+    ReservePins(pins, pins->count + obstacle_pin);
+    for(int i = pins->count; i < pins->count + obstacle_pin; i++){
+        pins->angle[i] = DegreesToAngle(def->obstacleAngles[i - pins->count]);
+        pins->yOffset[i] = ATTACH_RADIUS;
+        pins->collided[i] = false;
+        AngleIndexInsert(&state->attachedIndex, BoardRelativeAngle(state->boardAngle, pins->angle[i]), i);
+    }
+    state->level_pin = pins->count + def->level_pin;
+    pins->count += obstacle_pin;
+    pins->attachedCount = pins->count;
+}
+
+void setLevel(GameState *state, int level) {
+
+    if (level < 1) level = 1;
+    state->current_level = level;
+    AddLevel(state, level);
+
+}
+
+void StartLevel(GameState *state, int level) {
+    ResetGame(state);
+    setLevel(state, level);
+}
+
+// Moves every pin out by a ring and puts the next stage on the inner ring.
+// Only the inner ring can be hit, so the collision index starts empty.
+static void NextStage(GameState *state) {
+    PinSet *pins = &state->pins;
+    if (state->stage > 0) {
+        for (int i = 0; i < pins->count; i++) pins->yOffset[i] += ENDLESS_RING_SPACING;
+        state->rings++;
+    }
+    state->stage++;
+    state->stageStartTick = state->tick;
+    state->ringStart = pins->count;
+    AngleIndexClear(&state->attachedIndex);
+
+    state->current_level = (state->stage - 1) % ENDLESS_LEVEL_CYCLE + 1;
+    AddLevel(state, state->current_level);
+}
+
+void StartEndless(GameState *state) {
+    ResetGame(state);
+    state->endless = true;
+    NextStage(state);
+}
+
+int GameUpdate(GameState *state, GameInput input) {
+    int events = GAME_EVENT_NONE;
+    PinSet *pins = &state->pins;
+
+    if (!state->gameOver) {
+        if (input.launch && pins->count < state->level_pin && ReservePins(pins, pins->count + 1)) {
+            int i = pins->count++;
+            pins->angle[i] = LAUNCH_ANGLE;
+            pins->collided[i] = false;
+            // Moved by a full PIN_SPEED below, like every flying pin
+            pins->yOffset[i] = PIN_LAUNCH_OFFSET + PIN_SPEED * input.launchSubtick / GAME_SUBTICKS;
+            long maxLag = state->tick - state->stageStartTick;
+            for (int lag = 0; lag < input.launchLag && lag < GAME_MAX_LAUNCH_LAG && lag < maxLag; lag++) {
+                pins->yOffset[i] -= PIN_SPEED;
+            }
+            events |= GAME_EVENT_LAUNCH;
+        }
+
+        state->tick++;
+        state->rotationTimer = 1.0 + state->tick * (double)SIM_DT;
+        float step = LevelRotationStep(&state->levelRecord, state->tick);
+        state->rotationSpeed = fabsf(step);
+        state->reverse_rotation = step < 0;
+
+        BinaryAngle turn = DegreesToAngle(step);
+        state->boardAngle += turn;
+        // Pins attaching this step only start turning on the next one
+        SIM_BEGIN(PROFILE_PIN_UPDATE);
+        RotatePins(pins->angle, pins->attachedCount, turn);
+        for (int i = pins->attachedCount; i < pins->count; i++) {
+            pins->yOffset[i] -= PIN_SPEED;
+        }
+        while (pins->attachedCount < pins->count && pins->yOffset[pins->attachedCount] <= ATTACH_RADIUS) {
+            int i = pins->attachedCount++;
+            pins->yOffset[i] = ATTACH_RADIUS;
+            events |= GAME_EVENT_ATTACH;
+            events |= AttachPin(state, i);
+        }
+        SIM_END(PROFILE_PIN_UPDATE);
+
+        bool allAttached = pins->attachedCount == pins->count;
+        if (pins->count == state->level_pin && allAttached && !state->gameOver) {
+            if (state->endless) {
+                events |= GAME_EVENT_STAGE_PASSED;
+                NextStage(state);
+            } else {
+                events |= GAME_EVENT_LEVEL_PASSED;
+            }
+        }
+    }
+
+    if (state->failTriggered) {
+        state->failTimer += SIM_DT;
+        if (state->failTimer >= 1.0f) {
+            state->failTriggered = false;
+            events |= GAME_EVENT_FAIL;
+        }
+    }
+
+    return events;
+}
@@ -0,0 +1,171 @@
+#ifndef GAME_H
+#define GAME_H
+
+#include "angle_index.h"
+#include "level_pack.h"
+#include <stdbool.h>
+#include <stdint.h>
+
+#define ATTACH_RADIUS 160
+// Whole pixels, so compile-time checks can use them as integers
+#define PIN_SPEED_PX 6
+#define PIN_LAUNCH_OFFSET_PX 200
+#define PIN_SPEED ((float)PIN_SPEED_PX)
+#define PIN_LAUNCH_OFFSET ((float)PIN_LAUNCH_OFFSET_PX)
+#define COLLISION_THRESHOLD 9.0f
+// COLLISION_THRESHOLD in binary angle units. Rotation steps are given in
+// degrees and each is rounded to the nearest unit, so a gap of exactly
+// COLLISION_THRESHOLD can come out a few units short after many steps;
+// COLLISION_SLACK units (about 0.005 degrees, over 130000 steps of
+// rounding) keep such a gap clear, as it is in degrees.
+#define COLLISION_SLACK (1u << 16)
+#define COLLISION_ANGLE ((BinaryAngle)(COLLISION_THRESHOLD * (BINARY_ANGLE_TURN / 360.0)) - COLLISION_SLACK)
+// Where a launched pin attaches, straight below the core
+#define LAUNCH_ANGLE BINARY_ANGLE_QUARTER
+// Most pins that fit around the core without touching, 360 / COLLISION_THRESHOLD
+#define MAX_RING_PINS 40
+
+// Endless mode plays stages on one board. Each passed stage moves every
+// pin out by a ring and the next stage's obstacles go on the inner ring,
+// so pins keep accumulating. Stages cycle through the first
+// ENDLESS_LEVEL_CYCLE levels. ENDLESS_LEVEL stands for endless mode where
+// a level number is expected, such as in recordings.
+#define ENDLESS_LEVEL 0
+#define ENDLESS_LEVEL_CYCLE 20
+#define ENDLESS_RING_SPACING 26.0f
+
+// The simulation always advances in steps of SIM_DT seconds, whatever the
+// display refresh rate. PIN_SPEED and rotation speeds are per step.
+#define SIM_HZ 60
+#define SIM_DT (1.0f / SIM_HZ)
+
+// Pins as separate arrays, indexed by launch order (obstacles first). All
+// pins fly at the same speed and attach in launch order, so the attached
+// pins are always [0, attachedCount) and the flying ones
+// [attachedCount, count). For an attached pin yOffset is the radius of
+// its ring.
+//
+// The arrays share one block that doubles when full, so adding a pin
+// never allocates except when the capacity runs out, and emptying the
+// set is O(1): memory is kept for the next level.
+typedef struct {
+    BinaryAngle *angle;
+    float *yOffset;
+    bool *collided;
+    int count;
+    int attachedCount;
+    int capacity;
+    void *block;
+} PinSet;
+
+// One pin as the renderer sees it
+typedef struct {
+    BinaryAngle angle;
+    float yOffset;
+    bool attached;
+    bool collided;
+} Pin;
+
+static inline Pin GetPin(const PinSet *pins, int i) {
+    return (Pin){ pins->angle[i], pins->yOffset[i], i < pins->attachedCount, pins->collided[i] };
+}
+
+// Makes room for at least capacity pins, keeping those in use. A zeroed
+// PinSet is a valid empty one.
+bool ReservePins(PinSet *pins, int capacity);
+void FreePins(PinSet *pins);
+// Copies the pins in use, for keeping the previous step around
+void CopyPins(PinSet *dst, const PinSet *src);
+
+// Everything the game scene needs to simulate a level. Contains no raylib
+// types so it can be stepped without a window or an audio device.
+typedef struct {
+    PinSet pins;
+    int level_pin;
+    int current_level;
+    // Pin counts, obstacles and rotation schedule of current_level
+    LevelRecord levelRecord;
+
+    // Steps simulated since the level started
+    long tick;
+    // tick the current level or endless stage started at. Launches belong
+    // to the stage, so a lagged one never reaches back before it.
+    long stageStartTick;
+
+    float rotationSpeed;
+    float rotationTimer;
+    bool reverse_rotation;
+    // Total rotation applied to attached pins since the level started
+    BinaryAngle boardAngle;
+    // Attached pins by angle relative to boardAngle, for collision tests
+    AngleIndex attachedIndex;
+
+    bool gameOver;
+    bool failTriggered;
+    float failTimer;
+
+    // Indices of the first pin pair that collided, -1 if none
+    int collidedA, collidedB;
+
+    bool endless;
+    int stage;          // endless stages started, from 1
+    int rings;          // rings the board's pins have moved out by
+    int ringStart;      // first pin of the inner ring
+} GameState;
+
+// A launch can be pressed at any point within a step. launchSubtick is the
+// part of the step that had already passed, in 1/GAME_SUBTICKS units; the
+// new pin starts that much further back, so it is where it would be had it
+// left at the moment of the press.
+//
+// A press that arrives after its step was simulated sets launchLag to the
+// number of steps since then, and the pin is moved on by that many steps.
+// Flying pins affect nothing until they attach, and GAME_MAX_LAUNCH_LAG
+// steps are too few for one to attach, so this matches a launch on time
+// in that step, with two limits. GameUpdate() cuts the lag short at
+// stageStartTick, so a launch is never moved back across a stage or level
+// start; the caller must record it in the stage's first step. And nothing
+// here keeps launches in order: the caller must not place a lagged launch
+// in or before the step of the previous launch.
+#define GAME_SUBTICKS 256
+#define GAME_MAX_LAUNCH_LAG 6
+
+typedef struct {
+    bool launch;
+    uint8_t launchSubtick;
+    uint8_t launchLag;
+} GameInput;
+
+// Bit flags returned by GameUpdate() so the caller can play sounds and
+// switch scenes.
+typedef enum {
+    GAME_EVENT_NONE = 0,
+    GAME_EVENT_LAUNCH = 1 << 0,
+    GAME_EVENT_ATTACH = 1 << 1,
+    GAME_EVENT_COLLISION = 1 << 2,
+    GAME_EVENT_LEVEL_PASSED = 1 << 3,
+    GAME_EVENT_FAIL = 1 << 4,
+    GAME_EVENT_STAGE_PASSED = 1 << 5,   // endless mode only
+} GameEvent;
+
+void InitGameState(GameState *state);
+// Releases the pin storage; the state can be initialised again afterwards
+void FreeGameState(GameState *state);
+void ResetGame(GameState *state);
+void setLevel(GameState *state, int level);
+void StartLevel(GameState *state, int level);
+void StartEndless(GameState *state);
+
+// Levels come from this pack when one is set, otherwise from the built-in
+// table. The pack must stay loaded while it is in use.
+void SetLevelPack(const LevelPack *pack);
+
+// Angle of a pin relative to the board rotation
+static inline BinaryAngle BoardRelativeAngle(BinaryAngle boardAngle, BinaryAngle angle) {
+    return angle - boardAngle;
+}
+
+// Advances the game scene by one SIM_DT step.
+int GameUpdate(GameState *state, GameInput input);
+
+#endif
@@ -0,0 +1,83 @@
+#include "input.h"
+#include "raylib.h"
+#include <stdlib.h>
+#include <string.h>
+
+#if !defined(AA_NO_GLFW_INPUT) && defined(__has_include)
+    #if __has_include(<GLFW/glfw3.h>)
+        #include <GLFW/glfw3.h>
+        #define LAUNCH_INPUT_GLFW
+    #endif
+#endif
+
+static double presses[LAUNCH_QUEUE_SIZE];
+static int pressCount = 0;
+static bool hooked = false;
+
+static float latencies[LATENCY_SAMPLES];
+static int latencyNext = 0;
+static int latencyCount = 0;
+
+#if defined(LAUNCH_INPUT_GLFW)
+static GLFWkeyfun raylibKeyCallback = NULL;
+
+// Runs inside PollInputEvents(), on the main thread, so glfwGetTime() is
+// when events were polled rather than when the key went down
+static void KeyCallback(GLFWwindow *window, int key, int scancode, int action, int mods) {
+    if (key == GLFW_KEY_SPACE && action == GLFW_PRESS && pressCount < LAUNCH_QUEUE_SIZE) {
+        presses[pressCount++] = glfwGetTime();
+    }
+    if (raylibKeyCallback) raylibKeyCallback(window, key, scancode, action, mods);
+}
+#endif
+
+void InitLaunchInput(void) {
+    pressCount = 0;
+#if defined(LAUNCH_INPUT_GLFW)
+    GLFWwindow *window = GetWindowHandle();
+    if (window && !hooked) {
+        raylibKeyCallback = glfwSetKeyCallback(window, KeyCallback);
+        hooked = true;
+    }
+#endif
+}
+
+int TakeLaunchPresses(double *times, int capacity) {
+    if (!hooked) {
+        if (!IsKeyPressed(KEY_SPACE) || capacity < 1) return 0;
+        times[0] = GetTime();
+        return 1;
+    }
+
+    int count = pressCount < capacity ? pressCount : capacity;
+    memcpy(times, presses, count * sizeof(double));
+    pressCount = 0;
+    return count;
+}
+
+void AddLaunchLatency(double seconds) {
+    latencies[latencyNext] = (float)(seconds * 1000.0);
+    latencyNext = (latencyNext + 1) % LATENCY_SAMPLES;
+    if (latencyCount < LATENCY_SAMPLES) latencyCount++;
+}
+
+static int CompareFloat(const void *a, const void *b) {
+    float x = *(const float *)a, y = *(const float *)b;
+    return (x > y) - (x < y);
+}
+
+void GetLaunchLatency(LatencyStats *stats) {
+    memset(stats, 0, sizeof(*stats));
+    stats->count = latencyCount;
+    if (latencyCount == 0) return;
+
+    float sorted[LATENCY_SAMPLES];
+    memcpy(sorted, latencies, latencyCount * sizeof(float));
+    qsort(sorted, latencyCount, sizeof(float), CompareFloat);
+
+    double sum = 0.0;
+    for (int i = 0; i < latencyCount; i++) sum += sorted[i];
+    stats->average = (float)(sum / latencyCount);
+    stats->p99 = sorted[(latencyCount * 99 + 99) / 100 - 1];
+    stats->max = sorted[latencyCount - 1];
+}
@@ -0,0 +1,35 @@
+#ifndef INPUT_H
+#define INPUT_H
+
+#include <stdbool.h>
+
+#define LAUNCH_QUEUE_SIZE 16
+#define LATENCY_SAMPLES 256
+
+// Launch presses are collected by a key callback chained in front of
+// raylib's, so every press between two frames is kept where IsKeyPressed()
+// sees one. GLFW only runs the callback inside PollInputEvents(), once per
+// frame, so a press is stamped with the time of that poll, not when the key
+// went down: up to a frame late, and the same for every press in the frame.
+// Where GLFW is not available the callback is skipped and at most one press
+// per frame is seen, stamped just after the poll.
+void InitLaunchInput(void);
+// Moves the presses received since the last call into times, oldest first,
+// and returns how many there were. Call once per frame.
+int TakeLaunchPresses(double *times, int capacity);
+
+// Launch latency, in ms: from the poll that delivered a press to the end of
+// presenting the first frame that shows its pin. The wait from the key
+// going down to that poll, up to a frame, is not included, and neither is
+// display scanout.
+typedef struct {
+    float average;
+    float p99;
+    float max;
+    int count;      // samples kept, at most LATENCY_SAMPLES
+} LatencyStats;
+
+void AddLaunchLatency(double seconds);
+void GetLaunchLatency(LatencyStats *stats);
+
+#endif
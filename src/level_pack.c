@@ -0,0 +1,157 @@
+#include "level_pack.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+_Static_assert(sizeof(LevelPackHeader) == 32, "level pack header must be 32 bytes");
+_Static_assert(sizeof(LevelRecord) == 268, "level record layout changed, bump LEVEL_PACK_VERSION");
+
+// Rotation schedule of the built-in levels, in simulation steps: levels
+// above 4 turn twice as fast for 1 s out of every 3, and levels above 8
+// reverse for the last 2 s of every 8. Each level starts 1 s into its cycle.
+#define BUILTIN_STEPS_PER_SECOND 60
+
+static uint32_t Crc32(const unsigned char *bytes, size_t length) {
+    uint32_t crc = 0xFFFFFFFFu;
+    for (size_t i = 0; i < length; i++) {
+        crc ^= bytes[i];
+        for (int bit = 0; bit < 8; bit++) {
+            crc = (crc >> 1) ^ (0xEDB88320u & (0u - (crc & 1)));
+        }
+    }
+    return ~crc;
+}
+
+static bool ValidPack(const LevelPack *pack) {
+    if (pack->file.size < sizeof(LevelPackHeader)) return false;
+    const LevelPackHeader *header = pack->header;
+    if (memcmp(header->magic, LEVEL_PACK_MAGIC, 4) != 0) return false;
+    if (header->version < 1 || header->version > LEVEL_PACK_VERSION) return false;
+    if (header->recordSize != sizeof(LevelRecord)) return false;
+    if (header->recordsOffset % 8 != 0) return false;
+    return (uint64_t)header->recordsOffset + (uint64_t)header->levelCount * sizeof(LevelRecord) <= pack->file.size;
+}
+
+bool LoadLevelPack(LevelPack *pack, const char *path) {
+    memset(pack, 0, sizeof(*pack));
+
+    if (!MapFile(&pack->file, path)) return false;
+
+    pack->header = pack->file.data;
+    if (!ValidPack(pack)) {
+        UnloadLevelPack(pack);
+        return false;
+    }
+    pack->records = (const LevelRecord *)((const char *)pack->file.data + pack->header->recordsOffset);
+    return true;
+}
+
+void UnloadLevelPack(LevelPack *pack) {
+    UnmapFile(&pack->file);
+    memset(pack, 0, sizeof(*pack));
+}
+
+static uint32_t RecordsCrc(const LevelRecord *records, uint32_t count) {
+    uint32_t crc = Crc32((const unsigned char *)records, (size_t)count * sizeof(LevelRecord));
+    return crc != 0 ? crc : 1;
+}
+
+uint32_t LevelPackId(const LevelPack *pack) {
+    if (!pack->file.data) return 0;
+    if (pack->header->version >= 2) return pack->header->crc;
+    return RecordsCrc(pack->records, pack->header->levelCount);
+}
+
+const LevelRecord *GetPackLevel(const LevelPack *pack, int level) {
+    if (!pack->file.data || pack->header->levelCount == 0) return NULL;
+    long index = (long)level - (long)pack->header->firstLevel;
+    if (index < 0) index = 0;
+    if (index >= (long)pack->header->levelCount) index = pack->header->levelCount - 1;
+    return &pack->records[index];
+}
+
+static float BuiltinStep(int level, long t) {
+    const long second = BUILTIN_STEPS_PER_SECOND;
+    float speed = (level > 4 && t % (3 * second) < second) ? 2.0f : 1.0f;
+    bool reverse = level > 8 && t % (8 * second) >= 6 * second;
+    return reverse ? -speed : speed;
+}
+
+void BuiltinLevel(int level, LevelRecord *record) {
+    memset(record, 0, sizeof(*record));
+    if (level < 1) level = 1;
+
+    int level_pin;
+    if(level >= 9){
+        level_pin = (level-2)*2;
+    }
+    else{
+        level_pin = 3 + (level - 1) * 2;
+    }
+
+    int obstacle_pin = 0;
+
+    if (level >= 2 && level < 4) { obstacle_pin = 1; level_pin = 3 + level + 1;}
+    if (level >= 4 && level < 7) { obstacle_pin = 2; level_pin = level + 5;}
+    if (level >= 7 && level < 12) { obstacle_pin = 3; level_pin = level + 5;}
+    if (level >= 12 && level < 18) { obstacle_pin = 4; level_pin = level;}
+    if (level >= 18 && level < 25) { obstacle_pin = 5; level_pin = level;}
+    if (level >= 25 && level < 32) { obstacle_pin = 6; level_pin = level - 2;}
+
+    if(level >= 32){obstacle_pin=6; level_pin= level -1;}
+
+    record->level_pin = level_pin > UINT16_MAX ? UINT16_MAX : level_pin;
+    record->obstacleCount = obstacle_pin;
+    for (int i = 0; i < obstacle_pin; i++) {
+        record->obstacleAngles[i] = i*(360.0f/obstacle_pin);
+    }
+
+    long cycle = 1;
+    if (level > 4) cycle = 3 * BUILTIN_STEPS_PER_SECOND;
+    if (level > 8) cycle = 24 * BUILTIN_STEPS_PER_SECOND;
+    record->phase = BUILTIN_STEPS_PER_SECOND % cycle;
+
+    // Merge runs of equal steps into segments
+    int count = 0;
+    for (long t = 0; t < cycle; t++) {
+        float step = BuiltinStep(level, t);
+        if (count > 0 && record->segments[count - 1].step == step) {
+            record->segments[count - 1].end = t + 1;
+        } else {
+            record->segments[count++] = (RotationSegment){ t + 1, step };
+        }
+    }
+    record->segmentCount = count;
+}
+
+bool WriteLevelPack(const char *path, const LevelRecord *records, int count) {
+    FILE *file = fopen(path, "wb");
+    if (!file) return false;
+
+    LevelPackHeader header = {0};
+    memcpy(header.magic, LEVEL_PACK_MAGIC, 4);
+    header.version = LEVEL_PACK_VERSION;
+    header.levelCount = count;
+    header.firstLevel = 1;
+    header.recordSize = sizeof(LevelRecord);
+    header.recordsOffset = sizeof(LevelPackHeader);
+    header.crc = RecordsCrc(records, (uint32_t)count);
+
+    bool ok = fwrite(&header, sizeof(header), 1, file) == 1 &&
+              fwrite(records, sizeof(LevelRecord), count, file) == (size_t)count;
+    return fclose(file) == 0 && ok;
+}
+
+float LevelRotationStep(const LevelRecord *record, long tick) {
+    int count = record->segmentCount;
+    if (count == 0) return 0.0f;
+    if (count > MAX_ROTATION_SEGMENTS) count = MAX_ROTATION_SEGMENTS;
+
+    uint32_t cycle = record->segments[count - 1].end;
+    if (cycle == 0) return record->segments[0].step;
+    uint32_t t = (uint32_t)((record->phase + (unsigned long)tick) % cycle);
+    for (int i = 0; i < count; i++) {
+        if (t < record->segments[i].end) return record->segments[i].step;
+    }
+    return record->segments[count - 1].step;
+}
@@ -0,0 +1,81 @@
+#ifndef LEVEL_PACK_H
+#define LEVEL_PACK_H
+
+#include "mapped_file.h"
+#include <stdbool.h>
+#include <stdint.h>
+
+// Level pack files: a 32 byte LevelPackHeader followed by levelCount
+// fixed-size LevelRecords. Packs are memory-mapped and records are read
+// in place, so a level is found in O(1) by its number and loading does
+// not touch the records. Fields are in the byte order of the machine that
+// wrote the pack; on a machine of the other order the version does not
+// match and the pack is refused.
+//
+// Version 2 adds a CRC-32 of the records to the header, written once by
+// WriteLevelPack() so that recordings can name the pack without reading
+// it. Version 1 packs still load.
+#define LEVEL_PACK_MAGIC "AALP"
+#define LEVEL_PACK_VERSION 2
+
+#define MAX_OBSTACLES 16
+#define MAX_ROTATION_SEGMENTS 24
+
+typedef struct {
+    char magic[4];
+    uint32_t version;
+    uint32_t levelCount;
+    uint32_t firstLevel;
+    uint32_t recordSize;
+    uint32_t recordsOffset;
+    uint32_t crc;           // from version 2, see LevelPackId()
+    uint32_t reserved;
+} LevelPackHeader;
+
+// One part of a level's rotation cycle. end is the step within the cycle
+// where the segment stops; step is the signed rotation per simulation step
+// in degrees, negative for reverse rotation.
+typedef struct {
+    uint32_t end;
+    float step;
+} RotationSegment;
+
+typedef struct {
+    uint16_t level_pin;         // pins on the board when the level is done
+    uint16_t obstacleCount;     // of those, pins already placed at the start
+    float obstacleAngles[MAX_OBSTACLES];
+    // The cycle repeats every segments[segmentCount - 1].end steps and a
+    // level starts phase steps into it
+    uint32_t phase;
+    uint16_t segmentCount;
+    uint16_t reserved;
+    RotationSegment segments[MAX_ROTATION_SEGMENTS];
+} LevelRecord;
+
+typedef struct {
+    const LevelPackHeader *header;
+    const LevelRecord *records;
+    MappedFile file;
+} LevelPack;
+
+bool LoadLevelPack(LevelPack *pack, const char *path);
+void UnloadLevelPack(LevelPack *pack);
+
+// Record for a level number; numbers past the end of the pack repeat the
+// last level. Returns NULL for an empty pack.
+const LevelRecord *GetPackLevel(const LevelPack *pack, int level);
+
+// Identifies a pack's levels in recordings: the CRC-32 of its records,
+// never 0, which stands for the built-in levels. Read from the header of
+// a version 2 pack; a version 1 pack has its records read to compute it.
+uint32_t LevelPackId(const LevelPack *pack);
+
+// The original hard-coded levels
+void BuiltinLevel(int level, LevelRecord *record);
+
+bool WriteLevelPack(const char *path, const LevelRecord *records, int count);
+
+// Signed rotation for a step of a level, from its rotation schedule
+float LevelRotationStep(const LevelRecord *record, long tick);
+
+#endif
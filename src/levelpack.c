@@ -0,0 +1,46 @@
+// Writes the built-in levels to a level pack file.
+//
+//   cc -O2 -o aa_levelpack src/levelpack.c src/level_pack.c src/mapped_file.c
+//   ./aa_levelpack levels.aalp [count]
+//
+// The result can be edited with other tools or loaded by the game with
+// --levels levels.aalp.
+
+#include "level_pack.h"
+#include <stdio.h>
+#include <stdlib.h>
+
+int main(int argc, char **argv) {
+    if (argc < 2) {
+        fprintf(stderr, "usage: %s output [count]\n", argv[0]);
+        return 1;
+    }
+    int count = (argc > 2) ? atoi(argv[2]) : 100;
+    if (count < 1) count = 1;
+
+    LevelRecord *records = malloc(count * sizeof(LevelRecord));
+    if (!records) {
+        fprintf(stderr, "out of memory\n");
+        return 1;
+    }
+    for (int i = 0; i < count; i++) {
+        BuiltinLevel(i + 1, &records[i]);
+    }
+
+    if (!WriteLevelPack(argv[1], records, count)) {
+        fprintf(stderr, "%s: could not write level pack\n", argv[1]);
+        free(records);
+        return 1;
+    }
+
+    LevelPack pack;
+    if (!LoadLevelPack(&pack, argv[1])) {
+        fprintf(stderr, "%s: written pack does not load back\n", argv[1]);
+        free(records);
+        return 1;
+    }
+    printf("%s: %d levels, %zu bytes\n", argv[1], count, pack.file.size);
+    UnloadLevelPack(&pack);
+    free(records);
+    return 0;
+}
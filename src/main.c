@@ -1,616 +1,738 @@
 #include "raylib.h"
+#include "audio.h"
+#include "effects.h"
+#include "frame_pacer.h"
+#include "game.h"
+#include "input.h"
+#include "pin_render.h"
+#include "profiler.h"
+#include "text_cache.h"
+#include "recording.h"
+#include "save.h"
+#include "sim_thread.h"
+#include "telemetry.h"
+#include "ui.h"
 #include <math.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
+#include <time.h>
 
-#define MAX_PINS 250
 #define CORE_RADIUS 70
-#define ATTACH_RADIUS 160
 #define PIN_RADIUS 12
 #define PIN_DISTANCE 160
-#define PIN_SPEED 6.0f
-#define COLLISION_THRESHOLD 9.0f
 
 typedef enum scene { main_menu, game, fail, level_end, menu, settings, level_menu } scene;
 
 scene current_scene = main_menu;
 
+int current_level = 1;
+bool endless = false;
+bool level_initialized = false;
+bool music_on = true;
+bool sound_on = true;
+bool dark_mode = false;
+int highest_level_reached = 1;
+char levelInput[3] = "";
+int inputLength = 0;
+bool quitRequested = false;
+
+// Everything a menu scene's drawing depends on besides clicks
 typedef struct {
-    float angle;
-    float yOffset;
-    bool attached;
-    bool collided;
-} Pin;
+    scene current_scene;
+    bool dark_mode, sound_on, music_on;
+    int highest_level_reached;
+    char levelInput[3];
+} MenuView;
+
+void FillMenuView(MenuView *view, scene current, bool dark_mode, bool sound_on, bool music_on,
+                  int highest_level_reached, const char *levelInput) {
+    // Zeroed first so views can be compared with memcmp
+    memset(view, 0, sizeof(*view));
+    view->current_scene = current;
+    view->dark_mode = dark_mode;
+    view->sound_on = sound_on;
+    view->music_on = music_on;
+    view->highest_level_reached = highest_level_reached;
+    strncpy(view->levelInput, levelInput, sizeof(view->levelInput) - 1);
+}
 
-typedef struct {
-    int x, y, width, height, letterSize;
-} Button;
 
+// Where an attached pin is on a board centred on core
+Vector2 AttachedPinPosition(Vector2 core, Pin pin) {
+    Vector2 dir = AngleDirection(pin.angle);
+    return (Vector2){ core.x + dir.x * pin.yOffset, core.y + dir.y * pin.yOffset };
+}
 
-void ResetGame(Pin pins[MAX_PINS], int *pinCount, bool *gameOver) {
-    *pinCount = 0;
-    *gameOver = false;
-    for (int i = 0; i < MAX_PINS; i++) {
-        pins[i].attached = false;
-        pins[i].collided = false;
+// Per-phase averages and p99 over the profiler ring, pacing error, and the
+// recent frame times as a graph. Statistics are refreshed a few times a second.
+void DrawProfilerOverlay(int x, int y, int width) {
+    static ProfilePhaseStats stats[PROFILE_PHASE_COUNT];
+    static ProfilePhaseStats frame;
+    static PacingStats pacing;
+    static int refresh = 0;
+    if (refresh-- <= 0) {
+        GetProfileStats(stats, &frame);
+        GetPacingStats(&pacing);
+        refresh = 15;
     }
-}
 
-void setLevel(int level, int *level_pin, Pin pins[MAX_PINS], int *pinCount) {
+    LatencyStats latency;
+    GetLaunchLatency(&latency);
 
-    if (level < 1) level = 1;
-    if(level >= 9){
-        *level_pin = (level-2)*2;
-        if(level >=15){*level_pin = (level-2)*2;}
+    int lineHeight = 12;
+    int rows = 4;
+    for (int p = 0; p < PROFILE_PHASE_COUNT; p++) {
+        if (stats[p].frames > 0) rows++;
+    }
+    int graphHeight = 60;
+    int height = rows * lineHeight + graphHeight + 16;
+    DrawRectangle(x, y, width, height, Fade(BLACK, 0.75f));
+
+    int row = y + 4;
+    DrawText(TextFormat("frame  avg %.2f  p99 %.2f ms", frame.average, frame.p99), x + 6, row, 10, WHITE);
+    row += lineHeight;
+    DrawText(TextFormat("launch to present  avg %.1f  p99 %.1f ms", latency.average, latency.p99), x + 6, row, 10, WHITE);
+    row += lineHeight;
+    DrawText(TextFormat("%s (F4)  %.2f ms  error avg %.2f  p99 %.2f ms", PacingModeName(GetPacingMode()),
+                        pacing.target, pacing.average, pacing.p99), x + 6, row, 10, WHITE);
+    row += lineHeight;
+    DrawText("phase", x + 6, row, 10, GRAY);
+    DrawText("avg ms", x + width - 130, row, 10, GRAY);
+    DrawText("p99 ms", x + width - 64, row, 10, GRAY);
+    row += lineHeight;
+    for (int p = 0; p < PROFILE_PHASE_COUNT; p++) {
+        if (stats[p].frames == 0) continue;
+        DrawText(ProfilePhaseName(p), x + 6, row, 10, WHITE);
+        DrawText(TextFormat("%7.3f", stats[p].average), x + width - 130, row, 10, WHITE);
+        DrawText(TextFormat("%7.3f", stats[p].p99), x + width - 64, row, 10, WHITE);
+        row += lineHeight;
     }
-    else{
-        *level_pin = 3 + (level - 1) * 2;
+
+    // One bar per frame, full height is two 60 Hz frames
+    float times[PROFILE_FRAMES];
+    int barWidth = 2;
+    int count = GetProfileFrameTimes(times, (width - 12) / barWidth);
+    int graphY = row + 4;
+    float scale = graphHeight / 33.3f;
+    for (int i = 0; i < count; i++) {
+        int h = (int)(times[i] * scale);
+        if (h > graphHeight) h = graphHeight;
+        Color color = times[i] > 17.5f ? RED : GREEN;
+        DrawRectangle(x + 6 + i * barWidth, graphY + graphHeight - h, barWidth, h, color);
     }
+    DrawLine(x + 6, graphY + graphHeight / 2, x + width - 6, graphY + graphHeight / 2, YELLOW);
+}
 
-    int obstacle_pin = 0;
-    int reverse = 0;
+// Sets the pacing mode and the swap interval it needs
+void ApplyFramePacing(PacingMode mode, double capHz) {
+    SetFramePacing(mode, capHz, GetMonitorRefreshRate(GetCurrentMonitor()));
+    if (PacingUsesVsync(mode)) {
+        SetWindowState(FLAG_VSYNC_HINT);
+    } else {
+        ClearWindowState(FLAG_VSYNC_HINT);
+    }
+}
 
-    if (level >= 2 && level < 4) { obstacle_pin = 1; *level_pin = 3 + level + 1;}
-    if (level >= 4 && level < 7) { obstacle_pin = 2; *level_pin = level + 5;}
-    if (level >= 7 && level < 12) { obstacle_pin = 3; *level_pin = level + 5;}
-    if (level >= 12 && level < 18) { obstacle_pin = 4; *level_pin = level;}
-    if (level >= 18 && level < 25) { obstacle_pin = 5; *level_pin = level;}
-    if (level >= 25 && level < 32) { obstacle_pin = 6; *level_pin = level - 2;}
+// Widgets of every scene by scene number; the game scene has none
+WidgetTable sceneWidgets[level_menu + 1];
+int soundWidget, musicWidget;
+char enterLabel[16];
 
-    if(level >= 32){obstacle_pin=6; *level_pin= level -1;}
+void PlayBeep(void) {
+    if (sound_on) AudioPlayEffect(SOUND_BEEP);
+}
 
-    for(int i=0; i <= obstacle_pin; i++){
-                
-        pins[i].angle= i*(360.0f/obstacle_pin);
-        pins[i].yOffset= ATTACH_RADIUS;
-        pins[i].attached=true;
-        pins[i].collided=false;
+void GoToScene(int target) {
+    PlayBeep();
+    current_scene = target;
+}
+
+void PlayGame(int endlessRun) {
+    PlayBeep();
+    current_scene = game;
+    if (!endlessRun) current_level = highest_level_reached;
+    endless = endlessRun;
+    level_initialized = false;
+}
+
+void ToggleDarkMode(int beep) {
+    if (beep) PlayBeep();
+    dark_mode = !dark_mode;
+}
+
+void ToggleSound(int arg) {
+    (void)arg;
+    sound_on = !sound_on;
+    PlayBeep();
+}
+
+void ToggleMusic(int arg) {
+    (void)arg;
+    music_on = !music_on;
+    PlayBeep();
+}
+
+void TypeLevelDigit(int digit) {
+    if (inputLength >= 2) return;
+    levelInput[inputLength++] = '0' + digit;
+    levelInput[inputLength] = '\0';
+}
+
+void ClearLevelInput(int arg) {
+    (void)arg;
+    inputLength = 0;
+    levelInput[0] = '\0';
+}
+
+void EnterLevel(int arg) {
+    (void)arg;
+    int selectedLevel = atoi(levelInput);
+    if (selectedLevel >= 1 && selectedLevel <= highest_level_reached) {
+        current_level = selectedLevel;
+        endless = false;
+        level_initialized = false;
+        current_scene = game;
+    }
+}
+
+void NextLevel(int arg) {
+    (void)arg;
+    PlayBeep();
+    current_level++;
+    current_scene = game;
+    level_initialized = false;
+}
+
+void RetryLevel(int arg) {
+    (void)arg;
+    PlayBeep();
+    level_initialized = false;
+    current_scene = game;
+}
+
+void QuitGame(int arg) {
+    (void)arg;
+    PlayBeep();
+    quitRequested = true;
+}
+
+Widget MenuButton(float x, float y, float width, float height, const char *label, int fontSize,
+                  WidgetAction action, int arg) {
+    return (Widget){ { x, y, width, height }, WIDGET_FILLED, label, fontSize, DARKGRAY, WHITE, action, arg };
+}
+
+// Lays out the widgets of every menu scene for a window of width x height
+void LayoutMenus(int width, int height) {
+    for (int s = 0; s <= level_menu; s++) ClearWidgets(&sceneWidgets[s]);
+    int buttonX = (width - 120) / 2;
+
+    WidgetTable *t = &sceneWidgets[main_menu];
+    AddWidget(t, MenuButton(buttonX, 320, 120, 40, "Start", 20, PlayGame, false));
+    AddWidget(t, MenuButton(buttonX, 370, 120, 40, "Endless", 20, PlayGame, true));
+    AddWidget(t, MenuButton(300, 30, 70, 30, "MENU", 10, GoToScene, menu));
+    AddWidget(t, MenuButton(width / 2 - 30, 30, 120, 30, "Dark Mode", 10, ToggleDarkMode, true));
+
+    Widget back = { { 360, 10, 30, 30 }, WIDGET_LABEL, "x", 30, BLANK, BLACK, GoToScene, main_menu };
+    t = &sceneWidgets[menu];
+    soundWidget = AddWidget(t, MenuButton(80, 125, 120, 30, "Sound on", 10, ToggleSound, 0));
+    musicWidget = AddWidget(t, MenuButton(240, 125, 120, 30, "Music on", 10, ToggleMusic, 0));
+    AddWidget(t, MenuButton(240, 225, 120, 30, "Dark Mode", 10, ToggleDarkMode, false));
+    AddWidget(t, MenuButton(80, 225, 120, 30, "Replay Level", 10, GoToScene, level_menu));
+    AddWidget(t, back);
+
+    // Digits 1-9 three to a row, then Clear across two boxes and 0
+    static const char *digits[] = { "0", "1", "2", "3", "4", "5", "6", "7", "8", "9" };
+    int boxSize = 40, spacing = 20, startX = 115, startY = 220;
+    t = &sceneWidgets[level_menu];
+    for (int i = 0; i < 12; i++) {
+        float x = startX + (i % 3) * (boxSize + spacing);
+        float y = startY + (i / 3) * (boxSize + spacing);
+        if (i == 9) {
+            AddWidget(t, (Widget){ { x, y, 2 * boxSize + spacing, boxSize }, WIDGET_OUTLINED, "Clear", 20, BLACK, BLACK,
+                                   ClearLevelInput, 0 });
+            i++;
+            continue;
+        }
+        int digit = (i == 11) ? 0 : i + 1;
+        AddWidget(t, (Widget){ { x, y, boxSize, boxSize }, WIDGET_OUTLINED, digits[digit], 20, BLACK, BLACK,
+                               TypeLevelDigit, digit });
     }
-    *pinCount = obstacle_pin;
+    AddWidget(t, MenuButton(115, 480, 160, 40, enterLabel, 20, EnterLevel, 0));
+    back.arg = menu;
+    AddWidget(t, back);
 
+    t = &sceneWidgets[level_end];
+    AddWidget(t, MenuButton(buttonX, 320, 120, 40, "Next Level", 20, NextLevel, 0));
+    AddWidget(t, MenuButton(buttonX, 370, 120, 40, "Menu", 20, GoToScene, main_menu));
+
+    t = &sceneWidgets[fail];
+    AddWidget(t, MenuButton(buttonX, 270, 120, 40, "Retry", 20, RetryLevel, 0));
+    AddWidget(t, MenuButton(buttonX, 320, 120, 40, "EXIT", 20, QuitGame, 0));
+    AddWidget(t, MenuButton(buttonX, 370, 120, 40, "Menu", 20, GoToScene, main_menu));
+
+    for (int s = 0; s <= level_menu; s++) IndexWidgets(&sceneWidgets[s], width, height);
 }
 
-void DrawCenteredText(const char *text, Rectangle bounds, int fontSize, Color color) {
-    Vector2 size = MeasureTextEx(GetFontDefault(), text, fontSize, 0);
-    float x = bounds.x + (bounds.width - size.x) / 2;
-    float y = bounds.y + (bounds.height - size.y) / 2;
-    DrawText(text, x, y, fontSize, color);
+// Labels that show settings or what has been typed
+void UpdateMenuLabels(void) {
+    if (soundWidget >= 0) sceneWidgets[menu].widgets[soundWidget].label = sound_on ? "Sound on" : "Sound off";
+    if (musicWidget >= 0) sceneWidgets[menu].widgets[musicWidget].label = music_on ? "Music on" : "Music off";
+    snprintf(enterLabel, sizeof(enterLabel), "Enter %s", levelInput);
 }
 
-int main() {
+// Wall clock in seconds, usable before the window exists
+double Seconds(void) {
+    struct timespec ts;
+    timespec_get(&ts, TIME_UTC);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+// Pin position between the previous and the latest simulation step
+Pin InterpolatePin(Pin prev, Pin cur, float alpha) {
+    Pin pin = cur;
+    if (prev.attached && cur.attached) {
+        // The signed difference is the short way round
+        int32_t delta = (int32_t)(cur.angle - prev.angle);
+        pin.angle = prev.angle + (BinaryAngle)(int32_t)(delta * alpha);
+    } else if (!prev.attached && !cur.attached) {
+        pin.yOffset = prev.yOffset + (cur.yOffset - prev.yOffset) * alpha;
+    }
+    return pin;
+}
+
+int main(int argc, char **argv) {
+    double startupBegin = Seconds();
     const int screenWidth = 400;
     const int screenHeight = 600;
+    SetConfigFlags(FLAG_VSYNC_HINT);
     InitWindow(screenWidth, screenHeight, "aa Game in Raylib");
+
+    // --record <file> logs every level start and launch for aa_replay
+    // --levels <file> plays the levels of a level pack
+    // --profile <file> records frame timings and writes them at exit, as a
+    // Chrome trace for a .json file and as CSV otherwise
+    // --telemetry <prefix> logs every attempt to prefix-NNN.aatl for
+    // aa_telemetry
+    // --pacing <mode> presents with vsync (the default), uncapped,
+    // adaptive, or capped at a rate given in Hz
+    Recorder recorder = {0};
+    LevelPack levelPack = {0};
+    const char *recordPath = NULL;
+    const char *profilePath = NULL;
+    PacingMode pacingMode = PACING_VSYNC;
+    double pacingCap = 0.0;
+    for (int i = 1; i + 1 < argc; i++) {
+        if (strcmp(argv[i], "--record") == 0) recordPath = argv[i + 1];
+        if (strcmp(argv[i], "--levels") == 0) {
+            if (LoadLevelPack(&levelPack, argv[i + 1])) {
+                SetLevelPack(&levelPack);
+            } else {
+                TraceLog(LOG_WARNING, "Could not load level pack %s", argv[i + 1]);
+            }
+        }
+        if (strcmp(argv[i], "--profile") == 0) profilePath = argv[i + 1];
+        if (strcmp(argv[i], "--telemetry") == 0 && !StartTelemetry(argv[i + 1])) {
+            TraceLog(LOG_WARNING, "Could not open telemetry log %s", argv[i + 1]);
+        }
+        if (strcmp(argv[i], "--pacing") == 0 && !ParsePacingMode(argv[i + 1], &pacingMode, &pacingCap)) {
+            TraceLog(LOG_WARNING, "Unknown pacing mode %s", argv[i + 1]);
+        }
+    }
+    // Opened once the level pack is known, which the recording names
+    if (recordPath && !RecorderOpen(&recorder, recordPath, LevelPackId(&levelPack))) {
+        TraceLog(LOG_WARNING, "Could not open recording file %s", recordPath);
+    }
+    // F4 switches to the next pacing mode
+    ApplyFramePacing(pacingMode, pacingCap);
+    // F3 shows the profiler; it only records while shown or with --profile
+    bool showProfiler = false;
+    SetProfilerRecording(profilePath != NULL);
     
-    InitAudioDevice();  
-    Music game_music = LoadMusicStream("resources/Flying_me_softly.mp3");
-    Music beep_sound = LoadMusicStream("resources/beep.mp3");
-    Sound fail_sound = LoadSound("resources/fail.mp3");
-    Sound pin_sound = LoadSound("resources/pin.wav");
-
-    PlayMusicStream(game_music);
-    PlayMusicStream(beep_sound);
+    double windowReady = Seconds() - startupBegin;
+    double windowClock = GetTime();
+
+    // Audio comes up in the background while main_menu is already showing.
+    // Startup is cold when the asset archive was not yet in the page cache.
+    // The build writes the archive next to the executable; one packed by
+    // hand goes in resources/
+    AssetPack assets;
+    bool packed = LoadAssetPack(&assets, TextFormat("%sassets.aapk", GetApplicationDirectory())) ||
+                  LoadAssetPack(&assets, "resources/assets.aapk");
+    float residency = packed ? MappedFileResidency(&assets.file) : -1.0f;
+    StartAudioEngine(packed ? &assets : NULL);
+    bool startupReported = false;
+
+    PinBatch pinBatch;
+    LoadPinBatch(&pinBatch, PIN_RADIUS);
+    InitEffects();
+    InitTextCache();
+    InitLaunchInput();
+
+    RenderTexture2D menuCache = LoadRenderTexture(screenWidth, screenHeight);
+    MenuView menuCacheView = {0};
+    bool menuCacheDirty = true;
    
 
     Color lightBeige = (Color){ 243, 243, 224, 255 };
     Color darkBackground = (Color){60, 61, 55, 255};
     Color darkMaroon = (Color){66, 1, 1, 255};
-    Color transparent = (Color){0, 0, 0, 0};
 
-    Pin pins[MAX_PINS] = {0};
+    // The game scene runs on the simulation thread. This thread draws the
+    // latest snapshot of the current attempt and forwards launches.
+    StartSimThread(GetTime, &recorder);
+    int attempt = 0;
+    int attemptLevel = 0;
+    TelemetryFrames attemptFrames;
+    ClearTelemetryFrames(&attemptFrames);
+    unsigned int heardLaunches = 0, heardAttaches = 0, heardCollisions = 0;
+    // Press times of launches first drawn this frame, for latency
+    double launchesShown[SIM_LAUNCH_HISTORY];
+    int launchesShownCount = 0;
     
-    int highest_level_reached = 1;
-
-    FILE *sFile = fopen("save_file.txt", "r");
-    if (sFile) {
-        fscanf(sFile, "%d", &highest_level_reached);
-        fclose(sFile);
-    }
-
-    int pinCount = 0;
-    int current_level = 1;
-    int level_pin = 0;
+    SaveData save = { .highest_level_reached = 1 };
+    LoadSave(&save);
+    InitSaveSystem();
+    highest_level_reached = save.highest_level_reached;
+
+    int heardStage = 0;
+    // Attached pins from this one on have not had their burst yet; -1
+    // until the first snapshot of an attempt, whose obstacles get none
+    int heardAttached = -1;
+    // Endless boards zoom out as rings are added
+    float boardZoom = 1.0f;
+    Vector2 core = { screenWidth / 2, screenHeight / 3 };
+    Camera2D boardCamera = { .offset = core, .target = core, .zoom = 1.0f };
     int pin_start_point = screenHeight - 200;
-    int inputLength = 0;
-
-    float failTimer = 0;
-    float rotationSpeed = 0;
-    float rotationTimer= 1;
-
-    bool level_initialized = false;
-    bool gameOver = false;
-    bool failTriggered = false;
-    bool music_on = true;
-    bool sound_on = true;
-    bool dark_mode = false;
-    bool reverse_rotation = false;
+
     
-    char pinCountText[10];
-    char levelInput[3] = "";
+    TextLabel pinsLeftLabel = {0};
+    TextLabel levelLabel = {0};
+    TextLabel stageLabel = {0};
+    TextLabel availableLabel = {0};
+    TextLabel queueLabels[6] = {0};
+
+
+    LayoutMenus(screenWidth, screenHeight);
+
+    while (!WindowShouldClose() && !quitRequested) {
+        ProfileFrameBegin();
+        if (!startupReported && IsAudioEngineReady()) {
+            const char *kind = !packed ? "unpacked" : (residency >= 0.99f ? "warm" : (residency >= 0 ? "cold" : "packed"));
+            TraceLog(LOG_INFO, "STARTUP: window ready in %.1f ms, audio ready in %.1f ms (%s)",
+                     windowReady * 1000.0, (windowReady + GetAudioEngineReadyTime() - windowClock) * 1000.0, kind);
+            startupReported = true;
+        }
 
-   
-    SetTargetFPS(60);
+        PROFILE_BEGIN(PROFILE_INPUT);
+        if (IsKeyPressed(KEY_F3)) {
+            showProfiler = !showProfiler;
+            SetProfilerRecording(showProfiler || profilePath != NULL);
+        }
+        if (IsKeyPressed(KEY_F4)) {
+            pacingMode = (GetPacingMode() + 1) % PACING_MODE_COUNT;
+            ApplyFramePacing(pacingMode, pacingCap);
+        }
+        double pressTimes[LAUNCH_QUEUE_SIZE];
+        int presses = TakeLaunchPresses(pressTimes, LAUNCH_QUEUE_SIZE);
+        PROFILE_END(PROFILE_INPUT);
 
-    while (!WindowShouldClose()) {
         if (current_scene == game) {
             if (!level_initialized) {
-                ResetGame(pins, &pinCount, &gameOver);
-                setLevel(current_level, &level_pin, pins, &pinCount);
+                TelemetryAddFrames(&attemptFrames, attempt, attemptLevel);
+                ClearTelemetryFrames(&attemptFrames);
+                attemptLevel = endless ? ENDLESS_LEVEL : current_level;
+                attempt = SimStartLevel(attemptLevel);
+                heardLaunches = heardAttaches = heardCollisions = 0;
+                heardStage = 1;
+                heardAttached = -1;
+                boardZoom = 1.0f;
                 level_initialized = true;
             }
+            for (int i = 0; i < presses; i++) SimLaunch(pressTimes[i]);
+        }
 
-            if (!gameOver) {
-                if (IsKeyPressed(KEY_SPACE) && pinCount < level_pin) {
-                    pins[pinCount].angle = 90;
-                    pins[pinCount].yOffset = pin_start_point - 200;
-                    pins[pinCount].attached = false;
-                    pinCount++;
-                }
-
-
-                rotationTimer += GetFrameTime();
-                if (fmod(rotationTimer, 3.0f) < 1.0f && current_level > 4) {
-                    rotationSpeed = 2.0f;
-                } else {
-                    rotationSpeed = 1.0f;
-                }
-                
-                if (current_level > 8) {
-                float reverseCycle = fmod(rotationTimer, 8.0f);
-                reverse_rotation = (reverseCycle >= 6.0f);
-                }else{
-                reverse_rotation = false;
-                }
-
-                for (int i = 0; i < pinCount; i++) {
-                    if (!pins[i].attached) {
-                        pins[i].yOffset -= PIN_SPEED;
-                        if (pins[i].yOffset <= ATTACH_RADIUS){
-                            pins[i].yOffset = ATTACH_RADIUS;
-                            pins[i].attached = true;
-                            if(sound_on==true) PlaySound(pin_sound);
-                        }
-                    } else {
-                        pins[i].angle += reverse_rotation ? -rotationSpeed : rotationSpeed;
-                        if (pins[i].angle >= 360.0f) pins[i].angle -= 360.0f;
-                    }
-
-                    for (int j = 0; j < i; j++) {
-                        if (pins[i].attached && pins[j].attached) {
-                            float angleDiff = fabs(fmod(pins[i].angle - pins[j].angle + 360.0f, 360.0f));
-                            if (angleDiff < COLLISION_THRESHOLD || angleDiff > (360.0f - COLLISION_THRESHOLD)) {
-                                if(sound_on==true) PlaySound(fail_sound);
-                                pins[i].collided = true;
-                                pins[j].collided = true;
-                                gameOver = true;
-                                failTriggered = true;
-                                failTimer = 0.0f;
-                            }
-                        }
-                    }
-                }
+        // Until the simulation has picked up a new attempt, the game scene
+        // draws an empty board
+        const GameSnapshot *snapshot = SimLatestSnapshot();
+        bool snapshotCurrent = snapshot->attempt == attempt && attempt != 0;
 
-                // Level passed check
-                bool allAttached = true;
-                for (int i = 0; i < pinCount; i++) {
-                    if (!pins[i].attached) {
-                        allAttached = false;
-                        break;
-                    }
+        if (current_scene == game && snapshotCurrent) {
+            for (; heardLaunches != snapshot->launches; heardLaunches++) {
+                if (launchesShownCount < SIM_LAUNCH_HISTORY) {
+                    launchesShown[launchesShownCount++] = snapshot->launchPress[heardLaunches % SIM_LAUNCH_HISTORY];
                 }
+            }
+            if (sound_on == true) {
+                if (snapshot->attaches != heardAttaches) AudioPlayEffect(SOUND_PIN);
+                if (snapshot->collisions != heardCollisions) AudioPlayEffect(SOUND_FAIL);
+            }
+            if (sound_on == true && snapshot->stage > heardStage) AudioPlayEffect(SOUND_BEEP);
 
-                if (pinCount == level_pin && allAttached && !gameOver) {
-                    level_initialized = false;
-                    current_scene = level_end;
-                }
-                
+            const PinSet *pins = &snapshot->pins;
+            if (heardAttached < 0 || snapshot->stage > heardStage) heardAttached = pins->attachedCount;
+            for (; heardAttached < pins->attachedCount; heardAttached++) {
+                Pin pin = GetPin(pins, heardAttached);
+                SpawnAttachBurst(AttachedPinPosition(core, pin), pin.collided ? YELLOW : RED);
+            }
+            if (snapshot->collisions != heardCollisions && snapshot->collidedB >= 0 && snapshot->collidedB < pins->attachedCount) {
+                SpawnCollisionSparks(AttachedPinPosition(core, GetPin(pins, snapshot->collidedB)));
+            }
+            if (snapshot->stage > heardStage || snapshot->status == SIM_PASSED) {
+                SpawnPassPulse(core, ATTACH_RADIUS, RED);
+            }
+            heardAttaches = snapshot->attaches;
+            heardCollisions = snapshot->collisions;
+            heardStage = snapshot->stage;
+
+            AddTelemetryFrame(&attemptFrames, GetFrameTime() * 1000.0f);
+            if (snapshot->status != SIM_PLAYING) {
+                TelemetryAddFrames(&attemptFrames, attempt, attemptLevel);
+                ClearTelemetryFrames(&attemptFrames);
             }
-            if (failTriggered) {
-                failTimer += GetFrameTime();
-                if (failTimer >= 1.0f) {
-                    current_scene = fail;
-                    failTriggered = false;
+            if (snapshot->status == SIM_PASSED) {
+                // Once per pass, whether or not the level_end screen is
+                // ever redrawn
+                if (current_level >= highest_level_reached) {
+                    highest_level_reached = current_level + 1;
+                    save.highest_level_reached = highest_level_reached;
+                    RequestSave(&save);
                 }
+                level_initialized = false;
+                current_scene = level_end;
+            }
+            if (snapshot->status == SIM_FAILED) {
+                current_scene = fail;
             }
         }
 
-        BeginDrawing();
-        if (failTriggered) {
-            Color fail_color = dark_mode? darkMaroon : MAROON;
-            ClearBackground(fail_color);
-        } else {
-            Color background_color = dark_mode? darkBackground : lightBeige;
-            ClearBackground(background_color);
+        // A click goes to the widget under it in whichever menu is showing
+        if (IsWindowResized()) {
+            LayoutMenus(GetScreenWidth(), GetScreenHeight());
+            menuCacheDirty = true;
+        }
+        if (current_scene != game && IsMouseButtonPressed(MOUSE_LEFT_BUTTON)) {
+            DispatchClick(&sceneWidgets[current_scene], GetMousePosition());
         }
 
-        switch (current_scene) {
-            case main_menu: {
-                DrawText(".AA.", screenWidth/2 - 55, screenHeight/4, 60, BLACK);
-
-                //START Button
-                Rectangle startBtn = {(screenWidth - 120)/2, 320, 120, 40};
-                DrawRectangleRec(startBtn, DARKGRAY);
-                DrawCenteredText("Start", startBtn, 20, WHITE);
-                if (IsMouseButtonPressed(MOUSE_LEFT_BUTTON)) {
-                    Vector2 mouse = GetMousePosition();
-                    if (mouse.x >= startBtn.x && mouse.x <= startBtn.x + startBtn.width &&
-                        mouse.y >= startBtn.y && mouse.y <= startBtn.y + startBtn.height) {
-                        if(sound_on == true) UpdateMusicStream(beep_sound);
-                        current_scene = game;
-                        current_level = highest_level_reached;
-                        level_initialized = false; 
-                    }
-                }
-               
-                //MENU Button
-                Rectangle menuBtn = {300, 30, 70, 30};
-                DrawRectangleRec(menuBtn, DARKGRAY);
-                DrawCenteredText("MENU", menuBtn, 10, WHITE);
-                if (IsMouseButtonPressed(MOUSE_LEFT_BUTTON)) {
-                    Vector2 mouse = GetMousePosition();
-                    if (mouse.x >= menuBtn.x && mouse.x <= menuBtn.x + menuBtn.width &&
-                        mouse.y >= menuBtn.y  && mouse.y <= menuBtn.y + menuBtn.height) {
-                        if(sound_on == true) UpdateMusicStream(beep_sound);
-                        current_scene = menu;
-                    }
-                }
+        SetMusicPlaying(music_on && (current_scene == game || current_scene == level_end));
 
-                //Dark Mode Button
-                Rectangle darkModeBtn = {screenWidth/2 - 30, 30, 120, 30};
-                DrawRectangleRec(darkModeBtn, DARKGRAY);
-                DrawCenteredText("Dark Mode", darkModeBtn, 10, WHITE);
-                if (IsMouseButtonPressed(MOUSE_LEFT_BUTTON)) {
-                    Vector2 mouse = GetMousePosition();
-                    if (mouse.x >= darkModeBtn.x && mouse.x <= darkModeBtn.x + darkModeBtn.width &&
-                        mouse.y >= darkModeBtn.y && mouse.y <= darkModeBtn.y + darkModeBtn.height) {
-                        if(sound_on == true) UpdateMusicStream(beep_sound);
-                        dark_mode = !(dark_mode);
-                    }
-                }
+        // Menu scenes only change when something they show does, clicks
+        // included as they were handled above. Otherwise the last render
+        // is presented again.
+        bool cache_scene = current_scene != game;
+        MenuView view;
+        FillMenuView(&view, current_scene, dark_mode, sound_on, music_on, highest_level_reached, levelInput);
+        bool redraw = !cache_scene || menuCacheDirty || memcmp(&view, &menuCacheView, sizeof(view)) != 0;
 
-            } break;
-            case menu: {
-                //Buttons
-                Button soundBtn = {80, 125, 120, 30, 30};
-                Button musicBtn = {240, 125, 120, 30, 30};
-                Button darkModeBtn = {240, 225, 120, 30, 30};
-                Button replayBtn = {80, 225, 120, 30, 10};
-                Button backBtn = {360, 10, 30, 30, 30};
-                Button playRoundsBtn = {80, 325, 120, 30, 30};
-                
-                //Sound on/off Button
-                const char* sound_on_off = sound_on ? "on" : "off";
-            
-                DrawRectangle(soundBtn.x, soundBtn.y, soundBtn.width, soundBtn.height, DARKGRAY);
-                DrawCenteredText(sound_on ? "Sound on" : "Sound off", (Rectangle){soundBtn.x, soundBtn.y, soundBtn.width, soundBtn.height}, 10, WHITE);
-
-                if (IsMouseButtonPressed(MOUSE_LEFT_BUTTON)) {
-                    Vector2 mouse = GetMousePosition();
-                    if (mouse.x >= soundBtn.x && mouse.x <= soundBtn.x + soundBtn.width &&
-                        mouse.y >= soundBtn.y && mouse.y <= soundBtn.y + soundBtn.height) {
-                        sound_on = !(sound_on);
-                        if(sound_on == true) UpdateMusicStream(beep_sound);
+        if (cache_scene && redraw) {
+            BeginTextureMode(menuCache);
+        } else {
+            BeginDrawing();
+        }
 
-                    }
-                }
-            
-                //Music Button
-                const char* music_on_off = music_on ? "on" : "off";
-                
-                DrawRectangle(musicBtn.x, musicBtn.y, musicBtn.width, musicBtn.height, DARKGRAY);
-                DrawCenteredText(music_on ? "Music on" : "Music off", (Rectangle){musicBtn.x, musicBtn.y, musicBtn.width, musicBtn.height}, 10, WHITE);
-                
-                if (IsMouseButtonPressed(MOUSE_LEFT_BUTTON)) {
-                    Vector2 mouse = GetMousePosition();
-                    if (mouse.x >= musicBtn.x && mouse.x <= musicBtn.x + musicBtn.width &&
-                        mouse.y >= musicBtn.y && mouse.y <= musicBtn.y + musicBtn.height) {
-                        music_on = !(music_on);
-                        if(sound_on == true) UpdateMusicStream(beep_sound);
-                    }
-                }
-            
-                //Dark Mode Button
-                DrawRectangle(darkModeBtn.x, darkModeBtn.y, darkModeBtn.width, darkModeBtn.height, DARKGRAY);
-                DrawCenteredText("Dark Mode", (Rectangle){darkModeBtn.x, darkModeBtn.y, darkModeBtn.width, darkModeBtn.height}, 10, WHITE);
-
-                if (IsMouseButtonPressed(MOUSE_LEFT_BUTTON)) {
-                    Vector2 mouse = GetMousePosition();
-                    if (mouse.x >= darkModeBtn.x && mouse.x <= darkModeBtn.x + darkModeBtn.width &&
-                        mouse.y >= darkModeBtn.y && mouse.y <= darkModeBtn.y + darkModeBtn.height) {
-                        dark_mode = !(dark_mode);
-                    }
-                }
+        if (redraw) {
+            if (current_scene == game && snapshotCurrent && snapshot->failTriggered) {
+                Color fail_color = dark_mode? darkMaroon : MAROON;
+                ClearBackground(fail_color);
+            } else {
+                Color background_color = dark_mode? darkBackground : lightBeige;
+                ClearBackground(background_color);
+            }
 
-                // Replay Level Button
-                DrawRectangle(replayBtn.x, replayBtn.y, replayBtn.width, replayBtn.height, DARKGRAY);
-                DrawCenteredText("Replay Level", (Rectangle){replayBtn.x, replayBtn.y, replayBtn.width, replayBtn.height}, 10, WHITE);
+            // Scenes are listed in the same order as their draw phases
+            ProfilePhase drawPhase = PROFILE_DRAW_MAIN_MENU + current_scene;
+            PROFILE_BEGIN(drawPhase);
+            switch (current_scene) {
+                case main_menu: {
+                    DrawCachedText(".AA.", screenWidth/2 - 55, screenHeight/4, 60, BLACK);
+                } break;
+                case level_menu: {
+                    DrawCachedText("Replay Level", 125, 68, 28, BLACK);
+                    DrawCachedText("    Replay any level that \n you have already passed", 90, 110, 18, BLACK);
+                    SetTextLabel(&availableLabel, "Levels are available \n     between 1 & %d", highest_level_reached, 24);
+                    DrawTextLabel(&availableLabel, 90, 154, BLACK);
+                } break;
+                case game: {
+                    int coreX = screenWidth / 2;
+                    int coreY = screenHeight / 3;
+
+
+                    // Zoom eases towards fitting the outermost ring
+                    int rings = snapshotCurrent ? snapshot->rings : 0;
+                    float fit = (screenWidth / 2 - 8) / (ATTACH_RADIUS + rings * ENDLESS_RING_SPACING + PIN_RADIUS);
+                    if (fit > 1.0f) fit = 1.0f;
+                    boardZoom += (fit - boardZoom) * 0.1f;
+                    boardCamera.zoom = boardZoom;
+                    BeginMode2D(boardCamera);
+                    DrawCircle(coreX, coreY, CORE_RADIUS, BLACK);
+                
+                    //DrawCircleLines(coreX, coreY, ATTACH_RADIUS, LIGHTGRAY); -> Pins Attach Radius 
 
-                if (IsMouseButtonPressed(MOUSE_LEFT_BUTTON)) {
-                    Vector2 mouse = GetMousePosition();
-                    if (mouse.x >= replayBtn.x && mouse.x <= replayBtn.x + replayBtn.width &&
-                        mouse.y >= replayBtn.y && mouse.y <= replayBtn.y + replayBtn.height) {
-                        if(sound_on == true) UpdateMusicStream(beep_sound);
-                        current_scene = level_menu;
-                    }
-                }
-            
-                //Back To Main Menu Button
-                DrawRectangle(backBtn.x, backBtn.y, backBtn.width, backBtn.height, transparent);
-                DrawCenteredText("x", (Rectangle){backBtn.x, backBtn.y, backBtn.width, backBtn.height}, 30, BLACK);
-
-            
-                if (IsMouseButtonPressed(MOUSE_LEFT_BUTTON)) {
-                    Vector2 mouse = GetMousePosition();
-                    if (mouse.x >= backBtn.x && mouse.x <= backBtn.x + backBtn.width &&
-                        mouse.y >= backBtn.y && mouse.y <= backBtn.y + backBtn.height) {
-                        if(sound_on == true) UpdateMusicStream(beep_sound);
-                        current_scene = main_menu;                        
+                    if (!snapshotCurrent) {
+                        EndMode2D();
+                        break;
                     }
-                }
-            } break;
-            case level_menu: {
-
-                DrawText("Replay Level", 125, 68, 28, BLACK);
-                DrawText("    Replay any level that \n you have already passed", 90, 110, 18, BLACK);
-                DrawText(TextFormat("Levels are available \n     between 1 & %d", highest_level_reached), 90, 154, 24, BLACK);
-
-
-                int backWidth = 30; int backHeight = 30; int backX = 360; int backY = 10; int backLetterSize = 30;
-
-                int boxPerRow = 3;
-                int boxSize = 40;
-                int spacing = 20;
-                int startX = 115;
-                int startY = 220;
-
-                for (int i = 1; i <= 12; i++) {
-                    int displayNumber = (i == 12) ? 0 : i;
 
-                    int row = (i - 1) / boxPerRow;
-                    int col = (i - 1) % boxPerRow;
-                    int x = startX + col * (boxSize + spacing);
-                    int y = startY + row * (boxSize + spacing);
-
-                    // CLEAR BUTTON
-                    if (i == 10) {
-                        int clearWidth = 2 * boxSize + spacing;
-                        int clearHeight = boxSize;
-
-                        DrawRectangleLines(x, y, clearWidth, clearHeight, BLACK);
-                        DrawText("Clear", x + 15, y + 10, 20, BLACK);
-
-                        if (IsMouseButtonPressed(MOUSE_LEFT_BUTTON)) {
-                            Vector2 mouse = GetMousePosition();
-                            if (CheckCollisionPointRec(mouse, (Rectangle){x, y, clearWidth, clearHeight})) {
-                                inputLength = 0;
-                                levelInput[0] = '\0';
+                    // The snapshot shows the board as of snapshot->time; draw
+                    // it as far past its last step as the clock has moved on
+                    const PinSet *pins = &snapshot->pins;
+                    float alpha = (float)((GetTime() - snapshot->time) / SIM_DT);
+                    if (alpha < 0.0f) alpha = 0.0f;
+                    if (alpha > 1.0f) alpha = 1.0f;
+                    BeginPinBatch(&pinBatch, (Vector2){coreX, coreY});
+                    for (int i = 0; i < pins->count; i++) {
+                        Pin pin = GetPin(pins, i);
+                        if (i < snapshot->prev.count) pin = InterpolatePin(GetPin(&snapshot->prev, i), pin, alpha);
+                        if (!pin.attached) {
+                            AddPin(&pinBatch, (Vector2){coreX, coreY + pin.yOffset}, BLACK, false);
+                        } else {
+                            Color pinColor = RED;
+                            if(pin.collided) {
+                                pinColor = YELLOW;
                             }
-                        }
-                        i++; 
-                        continue;
-                    }
-
-                    // DIGIT BUTTONS
-                    DrawRectangleLines(x, y, boxSize, boxSize, BLACK);
-                    DrawText(TextFormat(" %d", displayNumber), x + 15, y + 10, 20, BLACK);
-
-                    if (IsMouseButtonPressed(MOUSE_LEFT_BUTTON)) {
-                        Vector2 mouse = GetMousePosition();
-                        if (CheckCollisionPointRec(mouse, (Rectangle){x, y, boxSize, boxSize}) && inputLength < 2) {
-                            levelInput[inputLength++] = '0' + displayNumber;
-                            levelInput[inputLength] = '\0';
-                        }
-                    }
-                }
-
-                // Enter Button
-                int enterX = 115;
-                int enterY = 480;
-                int enterWidth = 160;
-                int enterHeight = 40;
-
-                DrawRectangle(enterX, enterY, enterWidth, enterHeight, DARKGRAY);
-                DrawText("Enter ", enterX + 50, enterY + 10, 20, WHITE);
-                DrawText(levelInput, enterX + 110, enterY + 10, 20, WHITE);
-
-                if (IsMouseButtonPressed(MOUSE_LEFT_BUTTON)) {
-                    Vector2 mouse = GetMousePosition();
-                    if (CheckCollisionPointRec(mouse, (Rectangle){enterX, enterY, enterWidth, enterHeight})) {
-                        int selectedLevel = atoi(levelInput);
-                        if (selectedLevel >= 1 && selectedLevel <= highest_level_reached) {
-                            current_level = selectedLevel;
-                            level_initialized = false;
-                            current_scene = game;
+                            AddAttachedPin(&pinBatch, pin.angle, pin.yOffset, pinColor);
                         }
                     }
-                }
-                
-
-                //Back to menu
-                DrawRectangle(backX, backY, backWidth, backHeight, transparent);
-                Vector2 backTextSize = MeasureTextEx(GetFontDefault(), "x", backLetterSize, 0);
-                float backtextX = backX + (backWidth - backTextSize.x) / 2;
-                float backtextY = backY + (backHeight - backTextSize.y) / 2;
-                DrawText("x", backtextX, backtextY, backLetterSize, BLACK);
-
-                if (IsMouseButtonPressed(MOUSE_LEFT_BUTTON)) {
-                    Vector2 mouse = GetMousePosition();
-                    if (mouse.x >= backX && mouse.x <= backX + backWidth &&
-                        mouse.y >= backY  && mouse.y <= backY + backHeight) {
-                        if(sound_on == true) UpdateMusicStream(beep_sound);
-                        current_scene = menu;
-                        
-                    }
-                }
-            } break;
-            
-            case game: {
-                if(music_on == true){
-                    UpdateMusicStream(game_music);
-                }
+                    DrawPinBatch(&pinBatch);
+                    EndMode2D();
 
-                int coreX = screenWidth / 2;
-                int coreY = screenHeight / 3;
+                    // The queue stays at full size below the board
+                    BeginPinBatch(&pinBatch, (Vector2){coreX, coreY});
 
-                DrawCircle(coreX, coreY, CORE_RADIUS, BLACK);
-                
-                //DrawCircleLines(coreX, coreY, ATTACH_RADIUS, LIGHTGRAY); -> Pins Attach Radius 
+                    int remaining_pins = snapshot->level_pin - pins->count;
+                    int maxVisible;
+                    if(remaining_pins < 6) maxVisible = remaining_pins;
+                    else maxVisible = 6; 
 
-                for (int i = 0; i < pinCount; i++) {
-                    if (!pins[i].attached) {
-                        DrawCircle(coreX, coreY + pins[i].yOffset, PIN_RADIUS, BLACK);
-                    } else {
-                        float rad = (pins[i].angle) * DEG2RAD;
-                        float pinX = coreX + cos(rad) * ATTACH_RADIUS;
-                        float pinY = coreY + sin(rad) * ATTACH_RADIUS;
-                        DrawLine(coreX, coreY, pinX, pinY, BLACK);
-                       
-                        Color pinColor = RED;
-                        if(pins[i].collided) {
-                            pinColor = YELLOW;
-                        }
-                        DrawCircle(pinX, pinY, PIN_RADIUS, pinColor);
-                    }
-                }
+                    int baseY = pin_start_point;
+                    int spacing = 35;
 
-                if (pinCount < level_pin) {
-                    if (pinCount < level_pin) {
-                        int remaining_pins = level_pin - pinCount;
-                        int maxVisible;
-                        if(remaining_pins < 6) maxVisible = remaining_pins;
-                        else maxVisible = 6; 
-
-                        int baseY = pin_start_point;
-                        int spacing = 35;
-                    
-                        for (int i = 0; i < maxVisible; i++) {
-                            DrawCircle(coreX, baseY + i * spacing, PIN_RADIUS, BLACK);
-                    
-                            char numText[3];
-                            sprintf(numText, "%d", remaining_pins - i);
-                            int textWidth = MeasureText(numText, 15);
-                            DrawText(numText, coreX - textWidth / 2, baseY + i * spacing - 8, 15, WHITE);
-                        }
+                    for (int i = 0; i < maxVisible; i++) {
+                        AddPin(&pinBatch, (Vector2){coreX, baseY + i * spacing}, BLACK, false);
                     }
-                }
-
-                sprintf(pinCountText, "Pins: %d", level_pin - pinCount);
-                DrawText(pinCountText, 20, screenHeight - 50, 20, BLACK);
-
-                sprintf(pinCountText, "%d", current_level);
-                DrawText(pinCountText, coreX-15, coreY-40, 60, WHITE);
-                sprintf(pinCountText, "Level");
-                DrawText(pinCountText, coreX-25, coreY+10, 20, WHITE);
-            } break;
-
-            case level_end: {
+                    DrawPinBatch(&pinBatch);
 
-                if(music_on == true){
-                    UpdateMusicStream(game_music);
-                }
-
-                if (current_level >= highest_level_reached) {
-                    highest_level_reached = current_level + 1;
-                }
-
-                FILE *sFile = fopen("save_file.txt", "w");
-                if (sFile){
-                    fprintf(sFile, "%d\n", highest_level_reached);
-                    fclose(sFile);
-                }
-
-                DrawText("Level Passed!", 130, 250, 30, RED);
-
-                int btnWidth = 120;
-                int btnHeight = 40;
-                int btnX = (screenWidth - btnWidth) / 2;
-                int btnY = 320;
-
-                //Next Level Button
-                DrawRectangle(btnX, btnY, btnWidth, btnHeight, DARKGRAY);
-                DrawText("Next Level", btnX + 20, btnY + 10, 20, WHITE);
-
-                //Retry Button
-                int retryBtnY = 370;
-                DrawRectangle(btnX, retryBtnY, btnWidth, btnHeight, DARKGRAY);
-                DrawText("Menu", btnX + 30, retryBtnY + 10, 20, WHITE);
-
-                if (IsMouseButtonPressed(MOUSE_LEFT_BUTTON)) {
-                    Vector2 mouse = GetMousePosition();
-                    if (mouse.x >= btnX && mouse.x <= btnX + btnWidth &&
-                        mouse.y >= btnY && mouse.y <= btnY + btnHeight) {
-                            if(sound_on == true) UpdateMusicStream(beep_sound);
-                            current_level++;
-                            current_scene = game;
-                            level_initialized = false;
+                    // Each slot's label only changes when a pin is launched
+                    for (int i = 0; i < maxVisible; i++) {
+                        SetTextLabel(&queueLabels[i], "%d", remaining_pins - i, 15);
+                        DrawTextLabel(&queueLabels[i], coreX - queueLabels[i].width / 2, baseY + i * spacing - 8, WHITE);
                     }
 
-                    if (mouse.x >= btnX && mouse.x <= btnX + btnWidth &&
-                        mouse.y >= retryBtnY && mouse.y <= retryBtnY + btnHeight) {
-                        ResetGame(pins, &pinCount, &gameOver);
-                        if(sound_on == true) UpdateMusicStream(beep_sound);
-                        current_scene = main_menu;
+                    SetTextLabel(&pinsLeftLabel, "Pins: %d", snapshot->level_pin - pins->count, 20);
+                    DrawTextLabel(&pinsLeftLabel, 20, screenHeight - 50, BLACK);
+                    if (endless) {
+                        SetTextLabel(&stageLabel, "%d", snapshot->stage, 60);
+                        DrawTextLabel(&stageLabel, coreX - stageLabel.width / 2, coreY - 40, WHITE);
+                        DrawCachedText("Stage", coreX - 27, coreY + 10, 20, WHITE);
+                    } else {
+                        SetTextLabel(&levelLabel, "%d", current_level, 60);
+                        DrawTextLabel(&levelLabel, coreX-15, coreY-40, WHITE);
+                        DrawCachedText("Level", coreX-25, coreY+10, 20, WHITE);
                     }
-                }
-            } break;
-
-            case fail: {
-                DrawText("GAME OVER!", 130, 200, 30, RED);
+                } break;
 
-                int btnWidth = 120;
-                int btnHeight = 40;
-                int btnX = (screenWidth - btnWidth) / 2;
-                
-
-                int retryBtnY = 270;
-                DrawRectangle(btnX, retryBtnY, btnWidth, btnHeight, DARKGRAY);
-                DrawText("Retry", btnX + 30, retryBtnY + 10, 20, WHITE);
-
-                int exitBtnY = 320;
-                DrawRectangle(btnX, exitBtnY, btnWidth, btnHeight, DARKGRAY);
-                DrawText("EXIT", btnX + 35, exitBtnY + 10, 20, WHITE);
-
-                int menuyBtnY = 370;
-                DrawRectangle(btnX, menuyBtnY, btnWidth, btnHeight, DARKGRAY);
-                DrawText("Menu", btnX + 30, menuyBtnY + 10, 20, WHITE);
-
-                
+                case level_end: {
+                    DrawCachedText("Level Passed!", 130, 250, 30, RED);
+                } break;
 
-                if (IsMouseButtonPressed(MOUSE_LEFT_BUTTON)) {
-                    Vector2 mouse = GetMousePosition();
-
-                    if (mouse.x >= btnX && mouse.x <= btnX + btnWidth &&
-                        mouse.y >= retryBtnY && mouse.y <= retryBtnY + btnHeight) {
-                        ResetGame(pins, &pinCount, &gameOver);
-                        if(sound_on == true) UpdateMusicStream(beep_sound);
-                        level_initialized = false;
-                        current_scene = game;
-                    }
-
-                    if (mouse.x >= btnX && mouse.x <= btnX + btnWidth &&
-                        mouse.y >= exitBtnY && mouse.y <= exitBtnY + btnHeight) {
-                        if(sound_on == true) UpdateMusicStream(beep_sound);
-                        CloseWindow();
-                    }
+                case fail: {
+                    DrawCachedText("GAME OVER!", 130, 200, 30, RED);
+                } break;
+                default:
+                    break;
+            }
+            if (current_scene != game) {
+                UpdateMenuLabels();
+                DrawWidgets(&sceneWidgets[current_scene]);
+            }
+            PROFILE_END(drawPhase);
+        }
 
-                    if (mouse.x >= btnX && mouse.x <= btnX + btnWidth &&
-                        mouse.y >= menuyBtnY && mouse.y <= menuyBtnY + btnHeight) {
-                        if(sound_on == true) UpdateMusicStream(beep_sound);
-                        ResetGame(pins, &pinCount, &gameOver);
-                        current_scene = main_menu;
-                    }
-                }
-                failTimer = 0.0f;
-                failTriggered = false;
-            } break;
+        if (cache_scene) {
+            if (redraw) {
+                EndTextureMode();
+                menuCacheView = view;
+                menuCacheDirty = false;
+                BeginDrawing();
+            }
+            // Render textures are stored upside down
+            Rectangle source = { 0, 0, (float)menuCache.texture.width, -(float)menuCache.texture.height };
+            DrawTextureRec(menuCache.texture, source, (Vector2){ 0, 0 }, WHITE);
+        }
 
-            default:
-                break;
+        // Effects can outlive the game scene, so they are drawn over
+        // whichever scene is showing
+        UpdateEffects(GetFrameTime());
+        BeginMode2D(boardCamera);
+        DrawEffects();
+        EndMode2D();
+
+        // Drawing a scene may have changed what it shows, as passing a
+        // level does; draw the result before blocking again
+        MenuView after;
+        FillMenuView(&after, current_scene, dark_mode, sound_on, music_on, highest_level_reached, levelInput);
+        if (memcmp(&after, &view, sizeof(view)) != 0) menuCacheDirty = true;
+
+        AudioEndFrame();
+        ProfileAddTime(PROFILE_MUSIC_STREAM, TakeMusicUpdateTime());
+        if (showProfiler) DrawProfilerOverlay(10, 10, screenWidth - 20);
+
+        // Sleep until the next input event while a menu is idle; music keeps
+        // streaming on the audio thread
+        bool waitForEvents = !(current_scene == game || menuCacheDirty || showProfiler || GetEffectCount() > 0);
+        if (waitForEvents) {
+            EnableEventWaiting();
+        } else {
+            DisableEventWaiting();
+            PROFILE_BEGIN(PROFILE_PACING);
+            PaceFrame();
+            PROFILE_END(PROFILE_PACING);
         }
 
+        PROFILE_BEGIN(PROFILE_PRESENT);
         EndDrawing();
+        PROFILE_END(PROFILE_PRESENT);
+        FramePresented(waitForEvents);
+
+        // EndDrawing() has swapped buffers, so the pins launched this frame
+        // are now on their way to the display
+        if (launchesShownCount > 0) {
+            double presented = GetTime();
+            for (int i = 0; i < launchesShownCount; i++) AddLaunchLatency(presented - launchesShown[i]);
+            launchesShownCount = 0;
+        }
+        ProfileFrameEnd();
+    }
+    LatencyStats latency;
+    GetLaunchLatency(&latency);
+    if (latency.count > 0) {
+        TraceLog(LOG_INFO, "INPUT: launch to present latency avg %.1f ms, p99 %.1f ms, max %.1f ms over %d launches",
+                 latency.average, latency.p99, latency.max, latency.count);
+    }
+    PacingStats pacing;
+    GetPacingStats(&pacing);
+    if (pacing.count > 0) {
+        TraceLog(LOG_INFO, "PACING: %s, error avg %.2f ms, p99 %.2f ms, max %.2f ms over %d frames",
+                 PacingModeName(GetPacingMode()), pacing.average, pacing.p99, pacing.max, pacing.count);
+    }
+    if (profilePath && !WriteProfileTrace(profilePath)) {
+        TraceLog(LOG_WARNING, "Could not write profile to %s", profilePath);
     }
-    CloseAudioDevice();
+    CloseSaveSystem();
+    TelemetryAddFrames(&attemptFrames, attempt, attemptLevel);
+    StopSimThread();
+    RecorderClose(&recorder);
+    if (GetTelemetryDropped() > 0) TraceLog(LOG_WARNING, "TELEMETRY: %ld records dropped", GetTelemetryDropped());
+    StopTelemetry();
+    SetLevelPack(NULL);
+    UnloadLevelPack(&levelPack);
+    UnloadPinBatch(&pinBatch);
+    for (int s = 0; s <= level_menu; s++) FreeWidgets(&sceneWidgets[s]);
+    UnloadTextCache();
+    UnloadRenderTexture(menuCache);
+    CloseAudioEngine();
+    if (packed) UnloadAssetPack(&assets);
     CloseWindow();
     return 0;
 }
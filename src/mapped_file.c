@@ -0,0 +1,78 @@
+#define _DEFAULT_SOURCE
+#include "mapped_file.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#if defined(_WIN32)
+    #define MAPPED_FILE_NO_MMAP
+#else
+    #include <fcntl.h>
+    #include <sys/mman.h>
+    #include <sys/stat.h>
+    #include <unistd.h>
+#endif
+
+bool MapFile(MappedFile *file, const char *path) {
+    memset(file, 0, sizeof(*file));
+
+#if defined(MAPPED_FILE_NO_MMAP)
+    FILE *in = fopen(path, "rb");
+    if (!in) return false;
+    fseek(in, 0, SEEK_END);
+    long size = ftell(in);
+    fseek(in, 0, SEEK_SET);
+    if (size <= 0) {
+        fclose(in);
+        return false;
+    }
+    file->data = malloc(size);
+    file->size = fread(file->data, 1, size, in);
+    fclose(in);
+#else
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) return false;
+    struct stat st;
+    if (fstat(fd, &st) != 0 || st.st_size == 0) {
+        close(fd);
+        return false;
+    }
+    void *data = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (data == MAP_FAILED) return false;
+    file->data = data;
+    file->size = st.st_size;
+#endif
+    return true;
+}
+
+void UnmapFile(MappedFile *file) {
+    if (!file->data) return;
+#if defined(MAPPED_FILE_NO_MMAP)
+    free(file->data);
+#else
+    munmap(file->data, file->size);
+#endif
+    memset(file, 0, sizeof(*file));
+}
+
+float MappedFileResidency(const MappedFile *file) {
+#if defined(MAPPED_FILE_NO_MMAP)
+    (void)file;
+    return -1.0f;
+#else
+    if (!file->data) return -1.0f;
+    long pageSize = sysconf(_SC_PAGESIZE);
+    size_t pages = (file->size + pageSize - 1) / pageSize;
+    unsigned char *resident = malloc(pages);
+    if (!resident) return -1.0f;
+    if (mincore(file->data, file->size, (void *)resident) != 0) {
+        free(resident);
+        return -1.0f;
+    }
+    size_t count = 0;
+    for (size_t i = 0; i < pages; i++) count += resident[i] & 1;
+    free(resident);
+    return (float)count / pages;
+#endif
+}
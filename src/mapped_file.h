@@ -0,0 +1,21 @@
+#ifndef MAPPED_FILE_H
+#define MAPPED_FILE_H
+
+#include <stdbool.h>
+#include <stddef.h>
+
+// A whole file mapped read-only into memory. Platforms without mmap read
+// it into a heap buffer instead.
+typedef struct {
+    void *data;
+    size_t size;
+} MappedFile;
+
+bool MapFile(MappedFile *file, const char *path);
+void UnmapFile(MappedFile *file);
+
+// Fraction of the file's pages already in the page cache, 0..1. Returns
+// -1 when the platform cannot tell.
+float MappedFileResidency(const MappedFile *file);
+
+#endif
@@ -0,0 +1,145 @@
+// Build-time asset packer.
+//
+//   cc -O2 -o aa_packer src/packer.c -lraylib -lm
+//   ./aa_packer resources/assets.aapk --raw resources/Flying_me_softly.mp3
+//       --pcm resources/pin.wav --pcm resources/fail.mp3 --pcm resources/beep.mp3
+//
+// --raw stores a file as it is. --pcm decodes a sound and stores it as
+// 44.1 kHz stereo 16-bit samples, the format the audio mixer plays, so the
+// game can use it straight from the mapped archive. Assets are named by
+// their file name without the directory.
+
+#include "raylib.h"
+#include "asset_pack.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define MAX_ASSETS 64
+
+static const char *BaseName(const char *path) {
+    const char *slash = strrchr(path, '/');
+    const char *backslash = strrchr(path, '\\');
+    if (backslash > slash) slash = backslash;
+    return slash ? slash + 1 : path;
+}
+
+static void PutU16(unsigned char *out, uint16_t v) {
+    out[0] = v & 0xFF;
+    out[1] = (v >> 8) & 0xFF;
+}
+
+static void PutU32(unsigned char *out, uint32_t v) {
+    for (int i = 0; i < 4; i++) out[i] = (v >> (8 * i)) & 0xFF;
+}
+
+// Field by field in little-endian, whatever the host byte order and padding
+static void EncodeHeader(unsigned char out[sizeof(AssetPackHeader)], const AssetPackHeader *header) {
+    memset(out, 0, sizeof(AssetPackHeader));
+    memcpy(out, header->magic, 4);
+    PutU32(out + 4, header->version);
+    PutU32(out + 8, header->entryCount);
+    PutU32(out + 12, header->indexOffset);
+}
+
+static void EncodeEntry(unsigned char out[sizeof(AssetEntry)], const AssetEntry *entry) {
+    memcpy(out, entry->name, ASSET_NAME_LENGTH);
+    PutU32(out + 40, entry->type);
+    PutU32(out + 44, entry->offset);
+    PutU32(out + 48, entry->size);
+    PutU32(out + 52, entry->sampleRate);
+    PutU16(out + 56, entry->channels);
+    PutU16(out + 58, entry->sampleSize);
+    PutU32(out + 60, entry->frameCount);
+}
+
+static uint32_t Align(uint32_t offset) {
+    return (offset + ASSET_ALIGNMENT - 1) / ASSET_ALIGNMENT * ASSET_ALIGNMENT;
+}
+
+int main(int argc, char **argv) {
+    if (argc < 4) {
+        fprintf(stderr, "usage: %s output (--raw file | --pcm file)...\n", argv[0]);
+        return 1;
+    }
+    SetTraceLogLevel(LOG_WARNING);
+
+    AssetEntry entries[MAX_ASSETS] = {0};
+    void *data[MAX_ASSETS] = {0};
+    int count = 0;
+
+    for (int i = 2; i + 1 < argc && count < MAX_ASSETS; i += 2) {
+        const char *path = argv[i + 1];
+        AssetEntry *entry = &entries[count];
+        if (strlen(BaseName(path)) >= ASSET_NAME_LENGTH) {
+            fprintf(stderr, "%s: name too long\n", path);
+            return 1;
+        }
+        strcpy(entry->name, BaseName(path));
+
+        if (strcmp(argv[i], "--pcm") == 0) {
+            Wave wave = LoadWave(path);
+            if (wave.data == NULL) {
+                fprintf(stderr, "%s: could not decode\n", path);
+                return 1;
+            }
+            WaveFormat(&wave, 44100, 16, 2);
+            entry->type = ASSET_PCM;
+            entry->sampleRate = wave.sampleRate;
+            entry->channels = wave.channels;
+            entry->sampleSize = wave.sampleSize;
+            entry->frameCount = wave.frameCount;
+            entry->size = wave.frameCount * wave.channels * (wave.sampleSize / 8);
+            data[count] = wave.data;
+        } else if (strcmp(argv[i], "--raw") == 0) {
+            int size = 0;
+            data[count] = LoadFileData(path, &size);
+            if (data[count] == NULL) {
+                fprintf(stderr, "%s: could not read\n", path);
+                return 1;
+            }
+            entry->type = ASSET_RAW;
+            entry->size = size;
+        } else {
+            fprintf(stderr, "unknown option %s\n", argv[i]);
+            return 1;
+        }
+        count++;
+    }
+
+    AssetPackHeader header = {0};
+    memcpy(header.magic, ASSET_PACK_MAGIC, 4);
+    header.version = ASSET_PACK_VERSION;
+    header.entryCount = count;
+    header.indexOffset = sizeof(AssetPackHeader);
+
+    uint32_t offset = Align(sizeof(AssetPackHeader) + count * sizeof(AssetEntry));
+    for (int i = 0; i < count; i++) {
+        entries[i].offset = offset;
+        offset = Align(offset + entries[i].size);
+    }
+
+    FILE *file = fopen(argv[1], "wb");
+    if (!file) {
+        fprintf(stderr, "%s: could not create\n", argv[1]);
+        return 1;
+    }
+    static const char zeros[ASSET_ALIGNMENT] = {0};
+    unsigned char bytes[sizeof(AssetEntry)];
+    EncodeHeader(bytes, &header);
+    fwrite(bytes, sizeof(AssetPackHeader), 1, file);
+    for (int i = 0; i < count; i++) {
+        EncodeEntry(bytes, &entries[i]);
+        fwrite(bytes, sizeof(AssetEntry), 1, file);
+    }
+    for (int i = 0; i < count; i++) {
+        long pad = entries[i].offset - ftell(file);
+        fwrite(zeros, 1, pad, file);
+        fwrite(data[i], 1, entries[i].size, file);
+        printf("%-40s %-3s %9u bytes at %u\n", entries[i].name, entries[i].type == ASSET_PCM ? "pcm" : "raw",
+               entries[i].size, entries[i].offset);
+        MemFree(data[i]);
+    }
+    fclose(file);
+    return 0;
+}
@@ -0,0 +1,140 @@
+#include "pin_render.h"
+#include "rlgl.h"
+#include <math.h>
+#include <stdlib.h>
+
+// The top ANGLE_TABLE_BITS of an angle pick the entry and the rest
+// interpolate to the next one
+#define ANGLE_TABLE_BITS 12
+#define ANGLE_TABLE_SIZE (1 << ANGLE_TABLE_BITS)
+#define ANGLE_FRACTION_BITS (32 - ANGLE_TABLE_BITS)
+
+// One extra entry so interpolation never has to wrap the index
+static float cosTable[ANGLE_TABLE_SIZE + 1];
+static float sinTable[ANGLE_TABLE_SIZE + 1];
+static bool angleTableReady = false;
+
+static void InitAngleTable(void) {
+    for (int i = 0; i <= ANGLE_TABLE_SIZE; i++) {
+        double rad = (double)i / ANGLE_TABLE_SIZE * 2.0 * PI;
+        cosTable[i] = (float)cos(rad);
+        sinTable[i] = (float)sin(rad);
+    }
+    angleTableReady = true;
+}
+
+Vector2 AngleDirection(BinaryAngle angle) {
+    int i = angle >> ANGLE_FRACTION_BITS;
+    float t = (angle & ((1u << ANGLE_FRACTION_BITS) - 1)) * (1.0f / (1u << ANGLE_FRACTION_BITS));
+    return (Vector2){
+        cosTable[i] + (cosTable[i + 1] - cosTable[i]) * t,
+        sinTable[i] + (sinTable[i + 1] - sinTable[i]) * t,
+    };
+}
+
+void LoadPinBatch(PinBatch *batch, float radius) {
+    if (!angleTableReady) InitAngleTable();
+
+    // White disc with a one pixel soft edge, tinted per pin when drawn
+    int size = (int)ceilf(radius) * 2 + 2;
+    Image image = GenImageColor(size, size, BLANK);
+    Color *pixels = image.data;
+    float c = size / 2.0f;
+    for (int y = 0; y < size; y++) {
+        for (int x = 0; x < size; x++) {
+            float dx = x + 0.5f - c, dy = y + 0.5f - c;
+            float coverage = radius + 0.5f - sqrtf(dx * dx + dy * dy);
+            if (coverage <= 0) continue;
+            if (coverage > 1) coverage = 1;
+            pixels[y * size + x] = (Color){ 255, 255, 255, (unsigned char)(coverage * 255) };
+        }
+    }
+    batch->sprite = LoadTextureFromImage(image);
+    SetTextureFilter(batch->sprite, TEXTURE_FILTER_BILINEAR);
+    UnloadImage(image);
+
+    batch->radius = size / 2.0f;
+    batch->count = 0;
+    batch->capacity = 0;
+    batch->positions = NULL;
+    batch->colors = NULL;
+    batch->spokes = NULL;
+}
+
+void UnloadPinBatch(PinBatch *batch) {
+    UnloadTexture(batch->sprite);
+    free(batch->positions);
+    free(batch->colors);
+    free(batch->spokes);
+}
+
+static bool GrowPinBatch(PinBatch *batch) {
+    int capacity = batch->capacity > 0 ? batch->capacity * 2 : 256;
+    Vector2 *positions = realloc(batch->positions, capacity * sizeof(Vector2));
+    if (positions) batch->positions = positions;
+    Color *colors = realloc(batch->colors, capacity * sizeof(Color));
+    if (colors) batch->colors = colors;
+    bool *spokes = realloc(batch->spokes, capacity * sizeof(bool));
+    if (spokes) batch->spokes = spokes;
+    if (!positions || !colors || !spokes) return false;
+    batch->capacity = capacity;
+    return true;
+}
+
+void BeginPinBatch(PinBatch *batch, Vector2 center) {
+    batch->center = center;
+    batch->count = 0;
+}
+
+void AddPin(PinBatch *batch, Vector2 position, Color color, bool spoke) {
+    if (batch->count >= batch->capacity && !GrowPinBatch(batch)) return;
+    batch->positions[batch->count] = position;
+    batch->colors[batch->count] = color;
+    batch->spokes[batch->count] = spoke;
+    batch->count++;
+}
+
+void AddAttachedPin(PinBatch *batch, BinaryAngle angle, float radius, Color color) {
+    Vector2 dir = AngleDirection(angle);
+    Vector2 position = { batch->center.x + dir.x * radius, batch->center.y + dir.y * radius };
+    AddPin(batch, position, color, true);
+}
+
+void DrawPinBatch(const PinBatch *batch) {
+    if (batch->count == 0) return;
+
+    // Drawn in chunks that each fit in rlgl's vertex buffer, so a board of
+    // thousands of pins flushes a few times rather than overflowing it
+    for (int first = 0; first < batch->count; first += PIN_BATCH_CHUNK) {
+        int last = first + PIN_BATCH_CHUNK < batch->count ? first + PIN_BATCH_CHUNK : batch->count;
+        rlCheckRenderBatchLimit(2 * (last - first));
+        rlBegin(RL_LINES);
+        rlColor4ub(0, 0, 0, 255);
+        for (int i = first; i < last; i++) {
+            if (!batch->spokes[i]) continue;
+            rlVertex2f(batch->center.x, batch->center.y);
+            rlVertex2f(batch->positions[i].x, batch->positions[i].y);
+        }
+        rlEnd();
+    }
+
+    float r = batch->radius;
+    for (int first = 0; first < batch->count; first += PIN_BATCH_CHUNK) {
+        int last = first + PIN_BATCH_CHUNK < batch->count ? first + PIN_BATCH_CHUNK : batch->count;
+        rlCheckRenderBatchLimit(4 * (last - first));
+        rlSetTexture(batch->sprite.id);
+        rlBegin(RL_QUADS);
+        rlNormal3f(0.0f, 0.0f, 1.0f);
+        for (int i = first; i < last; i++) {
+            Vector2 p = batch->positions[i];
+            Color col = batch->colors[i];
+            rlColor4ub(col.r, col.g, col.b, col.a);
+            rlTexCoord2f(0.0f, 0.0f); rlVertex2f(p.x - r, p.y - r);
+            rlTexCoord2f(0.0f, 1.0f); rlVertex2f(p.x - r, p.y + r);
+            rlTexCoord2f(1.0f, 1.0f); rlVertex2f(p.x + r, p.y + r);
+            rlTexCoord2f(1.0f, 0.0f); rlVertex2f(p.x + r, p.y - r);
+        }
+        rlEnd();
+    }
+    rlSetTexture(0);
+}
@@ -0,0 +1,35 @@
+#ifndef PIN_RENDER_H
+#define PIN_RENDER_H
+
+#include "raylib.h"
+#include "game.h"
+
+// Pins queued for one frame and drawn together: all spokes in line
+// batches, then every pin as a textured quad of the same circle sprite.
+// The arrays grow with the board and are kept between frames.
+#define PIN_BATCH_CHUNK 2048
+
+typedef struct {
+    Texture2D sprite;
+    float radius;
+    Vector2 center;
+    int count;
+    int capacity;
+    Vector2 *positions;
+    Color *colors;
+    bool *spokes;
+} PinBatch;
+
+void LoadPinBatch(PinBatch *batch, float radius);
+void UnloadPinBatch(PinBatch *batch);
+
+void BeginPinBatch(PinBatch *batch, Vector2 center);
+void AddPin(PinBatch *batch, Vector2 position, Color color, bool spoke);
+// Adds a pin on the circle of the given radius around the batch center
+void AddAttachedPin(PinBatch *batch, BinaryAngle angle, float radius, Color color);
+void DrawPinBatch(const PinBatch *batch);
+
+// cos/sin of an angle from a lookup table
+Vector2 AngleDirection(BinaryAngle angle);
+
+#endif
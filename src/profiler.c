@@ -0,0 +1,229 @@
+#define _POSIX_C_SOURCE 199309L
+#include "profiler.h"
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+typedef struct {
+    uint32_t start;     // ns after the frame began
+    uint32_t duration;
+    uint8_t phase;
+} ProfileEvent;
+
+typedef struct {
+    int64_t start;
+    int64_t duration;
+    int64_t phaseTime[PROFILE_PHASE_COUNT];
+    int eventCount;
+    ProfileEvent events[PROFILE_EVENTS_PER_FRAME];
+} ProfileFrame;
+
+typedef struct {
+    ProfilePhase phase;
+    int64_t start;
+} OpenScope;
+
+atomic_bool profilerRecording = false;
+
+static ProfileFrame frames[PROFILE_FRAMES];
+static int nextFrame = 0;
+static int frameCount = 0;
+static bool frameOpen = false;
+// Open scopes are per thread; only the render thread has frameThread set
+static _Thread_local OpenScope scopes[PROFILE_MAX_DEPTH];
+static _Thread_local int depth = 0;
+static _Thread_local bool frameThread = false;
+// Time from scopes that ended on other threads, moved into the frame when
+// it ends
+static atomic_llong otherThreads[PROFILE_PHASE_COUNT];
+
+static const char *phaseNames[PROFILE_PHASE_COUNT] = {
+    "input", "simulation", "pin update", "collision",
+    "draw main_menu", "draw game", "draw fail", "draw level_end", "draw menu",
+    "draw settings", "draw level_menu", "music stream", "pacing", "present",
+};
+
+static int64_t Now(void) {
+    struct timespec ts;
+#if defined(_WIN32)
+    timespec_get(&ts, TIME_UTC);
+#else
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+#endif
+    return (int64_t)ts.tv_sec * 1000000000 + ts.tv_nsec;
+}
+
+const char *ProfilePhaseName(ProfilePhase phase) {
+    return (phase >= 0 && phase < PROFILE_PHASE_COUNT) ? phaseNames[phase] : "?";
+}
+
+void SetProfilerRecording(bool recording) {
+    // A frame that was open when recording stopped is dropped
+    if (!recording) frameOpen = false;
+    atomic_store(&profilerRecording, recording);
+}
+
+void ProfileFrameBegin(void) {
+    if (!atomic_load(&profilerRecording)) return;
+    ProfileFrame *frame = &frames[nextFrame];
+    memset(frame, 0, offsetof(ProfileFrame, events));
+    frame->start = Now();
+    frameOpen = true;
+    frameThread = true;
+    depth = 0;
+}
+
+void ProfileFrameEnd(void) {
+    if (!atomic_load(&profilerRecording) || !frameOpen) return;
+    ProfileFrame *frame = &frames[nextFrame];
+    frame->duration = Now() - frame->start;
+    for (int p = 0; p < PROFILE_PHASE_COUNT; p++) {
+        frame->phaseTime[p] += atomic_exchange_explicit(&otherThreads[p], 0, memory_order_relaxed);
+    }
+    frameOpen = false;
+    nextFrame = (nextFrame + 1) % PROFILE_FRAMES;
+    if (frameCount < PROFILE_FRAMES) frameCount++;
+}
+
+void ProfileBegin(ProfilePhase phase) {
+    if (depth == PROFILE_MAX_DEPTH) return;
+    scopes[depth].phase = phase;
+    scopes[depth].start = Now();
+    depth++;
+}
+
+void ProfileEnd(ProfilePhase phase) {
+    // Scopes left open when recording was switched off are dropped
+    int top = depth - 1;
+    while (top >= 0 && scopes[top].phase != phase) top--;
+    if (top < 0) return;
+    depth = top;
+    int64_t duration = Now() - scopes[depth].start;
+    if (!frameThread) {
+        atomic_fetch_add_explicit(&otherThreads[phase], duration, memory_order_relaxed);
+        return;
+    }
+    if (!frameOpen) return;
+
+    ProfileFrame *frame = &frames[nextFrame];
+    frame->phaseTime[phase] += duration;
+
+    // Every scope counts towards the totals; only the first ones of a
+    // frame are kept for the trace
+    if (frame->eventCount < PROFILE_EVENTS_PER_FRAME) {
+        ProfileEvent *event = &frame->events[frame->eventCount++];
+        event->start = (uint32_t)(scopes[depth].start - frame->start);
+        event->duration = (uint32_t)duration;
+        event->phase = (uint8_t)phase;
+    }
+}
+
+void ProfileAddTime(ProfilePhase phase, int64_t ns) {
+    if (!atomic_load(&profilerRecording) || !frameOpen) return;
+    frames[nextFrame].phaseTime[phase] += ns;
+}
+
+// Ring index of the i-th oldest recorded frame
+static int FrameIndex(int i) {
+    return (nextFrame - frameCount + i + PROFILE_FRAMES) % PROFILE_FRAMES;
+}
+
+static int CompareFloat(const void *a, const void *b) {
+    float x = *(const float *)a, y = *(const float *)b;
+    return (x > y) - (x < y);
+}
+
+static void Summarize(float *values, int count, ProfilePhaseStats *stats) {
+    stats->frames = count;
+    stats->average = 0.0f;
+    stats->p99 = 0.0f;
+    if (count == 0) return;
+
+    double sum = 0.0;
+    for (int i = 0; i < count; i++) sum += values[i];
+    qsort(values, count, sizeof(float), CompareFloat);
+    int rank = (count * 99 + 99) / 100;
+    stats->average = (float)(sum / count);
+    stats->p99 = values[rank - 1];
+}
+
+int GetProfileStats(ProfilePhaseStats stats[PROFILE_PHASE_COUNT], ProfilePhaseStats *frame) {
+    static float values[PROFILE_FRAMES];
+
+    for (int p = 0; p < PROFILE_PHASE_COUNT; p++) {
+        int count = 0;
+        for (int i = 0; i < frameCount; i++) {
+            int64_t ns = frames[FrameIndex(i)].phaseTime[p];
+            if (ns > 0) values[count++] = ns / 1e6f;
+        }
+        Summarize(values, count, &stats[p]);
+    }
+
+    if (frame) {
+        for (int i = 0; i < frameCount; i++) values[i] = frames[FrameIndex(i)].duration / 1e6f;
+        Summarize(values, frameCount, frame);
+    }
+    return frameCount;
+}
+
+int GetProfileFrameTimes(float *times, int capacity) {
+    int count = frameCount < capacity ? frameCount : capacity;
+    for (int i = 0; i < count; i++) {
+        times[i] = frames[FrameIndex(frameCount - count + i)].duration / 1e6f;
+    }
+    return count;
+}
+
+static void WriteChromeTrace(FILE *out) {
+    int64_t origin = frameCount > 0 ? frames[FrameIndex(0)].start : 0;
+    bool first = true;
+
+    fprintf(out, "{\"traceEvents\":[\n");
+    for (int i = 0; i < frameCount; i++) {
+        const ProfileFrame *frame = &frames[FrameIndex(i)];
+        double frameStart = (frame->start - origin) / 1e3;
+
+        fprintf(out, "%s{\"name\":\"frame\",\"ph\":\"X\",\"pid\":1,\"tid\":1,\"ts\":%.3f,\"dur\":%.3f}",
+                first ? "" : ",\n", frameStart, frame->duration / 1e3);
+        first = false;
+        for (int e = 0; e < frame->eventCount; e++) {
+            const ProfileEvent *event = &frame->events[e];
+            fprintf(out, ",\n{\"name\":\"%s\",\"ph\":\"X\",\"pid\":1,\"tid\":1,\"ts\":%.3f,\"dur\":%.3f}",
+                    phaseNames[event->phase], frameStart + event->start / 1e3, event->duration / 1e3);
+        }
+        // Work from other threads has no position in the frame, only a total
+        fprintf(out, ",\n{\"name\":\"%s\",\"ph\":\"C\",\"pid\":1,\"ts\":%.3f,\"args\":{\"ms\":%.4f}}",
+                phaseNames[PROFILE_MUSIC_STREAM], frameStart, frame->phaseTime[PROFILE_MUSIC_STREAM] / 1e6);
+    }
+    fprintf(out, "\n],\"displayTimeUnit\":\"ms\"}\n");
+}
+
+static void WriteCsv(FILE *out) {
+    int64_t origin = frameCount > 0 ? frames[FrameIndex(0)].start : 0;
+
+    fprintf(out, "frame,start_ms,frame_ms");
+    for (int p = 0; p < PROFILE_PHASE_COUNT; p++) fprintf(out, ",%s", phaseNames[p]);
+    fprintf(out, "\n");
+
+    for (int i = 0; i < frameCount; i++) {
+        const ProfileFrame *frame = &frames[FrameIndex(i)];
+        fprintf(out, "%d,%.4f,%.4f", i, (frame->start - origin) / 1e6, frame->duration / 1e6);
+        for (int p = 0; p < PROFILE_PHASE_COUNT; p++) fprintf(out, ",%.4f", frame->phaseTime[p] / 1e6);
+        fprintf(out, "\n");
+    }
+}
+
+bool WriteProfileTrace(const char *path) {
+    FILE *out = fopen(path, "w");
+    if (!out) return false;
+
+    size_t length = strlen(path);
+    if (length >= 5 && strcmp(path + length - 5, ".json") == 0) {
+        WriteChromeTrace(out);
+    } else {
+        WriteCsv(out);
+    }
+    return fclose(out) == 0;
+}
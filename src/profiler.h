@@ -0,0 +1,69 @@
+#ifndef PROFILER_H
+#define PROFILER_H
+
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stdint.h>
+
+// Phases of a frame. The two simulation phases are timed inside
+// GameUpdate() when game.c is built with AA_PROFILE defined.
+typedef enum {
+    PROFILE_INPUT,
+    PROFILE_SIMULATION,
+    PROFILE_PIN_UPDATE,
+    PROFILE_COLLISION,
+    PROFILE_DRAW_MAIN_MENU,
+    PROFILE_DRAW_GAME,
+    PROFILE_DRAW_FAIL,
+    PROFILE_DRAW_LEVEL_END,
+    PROFILE_DRAW_MENU,
+    PROFILE_DRAW_SETTINGS,
+    PROFILE_DRAW_LEVEL_MENU,
+    PROFILE_MUSIC_STREAM,
+    PROFILE_PACING,
+    PROFILE_PRESENT,
+    PROFILE_PHASE_COUNT
+} ProfilePhase;
+
+#define PROFILE_FRAMES 512
+#define PROFILE_EVENTS_PER_FRAME 64
+#define PROFILE_MAX_DEPTH 8
+
+// Scopes nest. Nothing is timed unless recording is on, and the check is
+// a single load and branch, so the macros can stay in hot paths.
+#define PROFILE_BEGIN(phase) do { if (atomic_load_explicit(&profilerRecording, memory_order_relaxed)) ProfileBegin(phase); } while (0)
+#define PROFILE_END(phase) do { if (atomic_load_explicit(&profilerRecording, memory_order_relaxed)) ProfileEnd(phase); } while (0)
+
+extern atomic_bool profilerRecording;
+
+// The last PROFILE_FRAMES frames are kept in a ring. Frames are bounded by
+// ProfileFrameBegin() and ProfileFrameEnd() on the render thread. Scopes
+// on other threads only add to the totals of the frame that is open when
+// they end.
+void SetProfilerRecording(bool recording);
+void ProfileFrameBegin(void);
+void ProfileFrameEnd(void);
+void ProfileBegin(ProfilePhase phase);
+void ProfileEnd(ProfilePhase phase);
+// Time spent on another thread during the current frame, such as the
+// audio thread's music decoding
+void ProfileAddTime(ProfilePhase phase, int64_t ns);
+
+const char *ProfilePhaseName(ProfilePhase phase);
+
+typedef struct {
+    float average;  // ms per frame, over frames that ran the phase
+    float p99;
+    int frames;     // frames in the ring that ran the phase
+} ProfilePhaseStats;
+
+// Per-phase statistics over the ring. Returns the number of frames in it.
+int GetProfileStats(ProfilePhaseStats stats[PROFILE_PHASE_COUNT], ProfilePhaseStats *frame);
+// Frame times in ms, oldest first. Returns how many were written.
+int GetProfileFrameTimes(float *times, int capacity);
+
+// Writes the ring as a Chrome trace (chrome://tracing, Perfetto) when path
+// ends in .json, otherwise as CSV with one row per frame.
+bool WriteProfileTrace(const char *path);
+
+#endif
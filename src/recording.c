@@ -0,0 +1,157 @@
+#include "recording.h"
+#include <stdlib.h>
+#include <string.h>
+
+// Steps to keep simulating after the last launch of an attempt. Enough for
+// the last pin to attach and the fail timer to run out.
+#define REPLAY_TAIL_TICKS (2 * SIM_HZ)
+
+static void PutRecord(unsigned char *out, Record record) {
+    out[0] = record.tick & 0xFF;
+    out[1] = (record.tick >> 8) & 0xFF;
+    out[2] = (record.tick >> 16) & 0xFF;
+    out[3] = (record.tick >> 24) & 0xFF;
+    out[4] = record.level & 0xFF;
+    out[5] = (record.level >> 8) & 0xFF;
+    out[6] = record.kind;
+    out[7] = record.subtick;
+}
+
+static Record GetRecord(const unsigned char *in) {
+    Record record;
+    record.tick = in[0] | (in[1] << 8) | (in[2] << 16) | ((uint32_t)in[3] << 24);
+    record.level = in[4] | (in[5] << 8);
+    record.kind = in[6];
+    record.subtick = in[7];
+    return record;
+}
+
+static void RecorderFlush(Recorder *recorder) {
+    unsigned char bytes[sizeof(recorder->buffer)];
+    for (int i = 0; i < recorder->buffered; i++) {
+        PutRecord(&bytes[i * 8], recorder->buffer[i]);
+    }
+    fwrite(bytes, 8, recorder->buffered, recorder->file);
+    fflush(recorder->file);
+    recorder->buffered = 0;
+}
+
+bool RecorderOpen(Recorder *recorder, const char *path, uint32_t levelPack) {
+    recorder->buffered = 0;
+    recorder->file = fopen(path, "wb");
+    if (!recorder->file) return false;
+
+    unsigned char header[12] = { 'A', 'A', 'R', 'C', RECORDING_VERSION, 0, 0, 0 };
+    for (int i = 0; i < 4; i++) header[8 + i] = (levelPack >> (8 * i)) & 0xFF;
+    fwrite(header, 1, sizeof(header), recorder->file);
+    return true;
+}
+
+void RecorderAdd(Recorder *recorder, RecordKind kind, long tick, int level, int subtick) {
+    if (!recorder->file) return;
+
+    Record record = { (uint32_t)tick, (uint16_t)level, (uint8_t)kind, (uint8_t)subtick };
+    recorder->buffer[recorder->buffered++] = record;
+    // Flush at every level start so a crash loses at most one attempt
+    if (kind == RECORD_LEVEL_START || recorder->buffered == 256) RecorderFlush(recorder);
+}
+
+void RecorderClose(Recorder *recorder) {
+    if (!recorder->file) return;
+    RecorderFlush(recorder);
+    fclose(recorder->file);
+    recorder->file = NULL;
+}
+
+bool LoadRecording(Recording *recording, const char *path) {
+    recording->records = NULL;
+    recording->count = 0;
+    recording->levelPack = RECORDING_BUILTIN_LEVELS;
+
+    FILE *file = fopen(path, "rb");
+    if (!file) return false;
+
+    unsigned char header[12];
+    if (fread(header, 1, 8, file) != 8 || memcmp(header, RECORDING_MAGIC, 4) != 0 ||
+        header[4] < 1 || header[4] > RECORDING_VERSION) {
+        fclose(file);
+        return false;
+    }
+    recording->version = header[4];
+    long headerSize = 8;
+    if (recording->version >= 3) {
+        if (fread(&header[8], 1, 4, file) != 4) {
+            fclose(file);
+            return false;
+        }
+        recording->levelPack = header[8] | (header[9] << 8) | (header[10] << 16) | ((uint32_t)header[11] << 24);
+        headerSize = 12;
+    }
+
+    fseek(file, 0, SEEK_END);
+    long size = ftell(file) - headerSize;
+    fseek(file, headerSize, SEEK_SET);
+
+    int count = (int)(size / 8);
+    unsigned char *bytes = malloc(size > 0 ? size : 1);
+    recording->records = malloc((count > 0 ? count : 1) * sizeof(Record));
+    count = (int)(fread(bytes, 8, count, file));
+    for (int i = 0; i < count; i++) {
+        recording->records[i] = GetRecord(&bytes[i * 8]);
+        if (recording->version < 2) recording->records[i].subtick = 0;
+    }
+    recording->count = count;
+    free(bytes);
+    fclose(file);
+    return true;
+}
+
+void UnloadRecording(Recording *recording) {
+    free(recording->records);
+    recording->records = NULL;
+    recording->count = 0;
+}
+
+int ReplayAttempt(const Recording *recording, int first, GameState *state, ReplayResult *result) {
+    const Record *records = recording->records;
+    int level = records[first].level;
+
+    int last = first + 1;
+    while (last < recording->count && records[last].kind == RECORD_LAUNCH) last++;
+
+    memset(result, 0, sizeof(*result));
+    result->level = level;
+    result->outcome = REPLAY_INCOMPLETE;
+    result->collidedA = -1;
+    result->collidedB = -1;
+
+    if (level == ENDLESS_LEVEL) {
+        StartEndless(state);
+    } else {
+        StartLevel(state, level);
+    }
+    int next = first + 1;
+    long endTick = (last > first + 1) ? records[last - 1].tick + REPLAY_TAIL_TICKS : REPLAY_TAIL_TICKS;
+
+    while (state->tick <= endTick) {
+        GameInput input = { .launch = next < last && records[next].tick == state->tick };
+        if (input.launch) input.launchSubtick = records[next++].subtick;
+
+        int events = GameUpdate(state, input);
+        if (events & GAME_EVENT_LAUNCH) result->launches++;
+        if (events & GAME_EVENT_LEVEL_PASSED) {
+            result->outcome = REPLAY_LEVEL_END;
+            break;
+        }
+        if (events & GAME_EVENT_FAIL) {
+            result->outcome = REPLAY_FAIL;
+            break;
+        }
+    }
+
+    result->ticks = state->tick;
+    result->stage = state->stage;
+    result->collidedA = state->collidedA;
+    result->collidedB = state->collidedB;
+    return last;
+}
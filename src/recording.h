@@ -0,0 +1,68 @@
+#ifndef RECORDING_H
+#define RECORDING_H
+
+#include "game.h"
+#include <stdint.h>
+#include <stdio.h>
+
+// Session recordings are a 12 byte header ("AARC", version, reserved, the
+// CRC of the level pack played) followed by 8 byte little-endian records
+// until the end of the file. Version 1 recordings have no launch subticks
+// and are read as subtick 0; versions 1 and 2 have an 8 byte header with
+// no pack CRC.
+#define RECORDING_MAGIC "AARC"
+#define RECORDING_VERSION 3
+// Pack CRC of a session played on the built-in levels
+#define RECORDING_BUILTIN_LEVELS 0
+
+typedef enum {
+    RECORD_LEVEL_START = 1,
+    RECORD_LAUNCH = 2,
+} RecordKind;
+
+typedef struct {
+    uint32_t tick;      // step index the event happened in, 0 at level start
+    uint16_t level;
+    uint8_t kind;
+    uint8_t subtick;    // GameInput.launchSubtick of a launch
+} Record;
+
+typedef struct {
+    FILE *file;
+    Record buffer[256];
+    int buffered;
+} Recorder;
+
+// levelPack is the LevelPackId() of the pack the session plays, or
+// RECORDING_BUILTIN_LEVELS
+bool RecorderOpen(Recorder *recorder, const char *path, uint32_t levelPack);
+void RecorderAdd(Recorder *recorder, RecordKind kind, long tick, int level, int subtick);
+void RecorderClose(Recorder *recorder);
+
+// Whole recording loaded into memory
+typedef struct {
+    Record *records;
+    int count;
+    int version;
+    uint32_t levelPack;     // as given to RecorderOpen(), from version 3
+} Recording;
+
+bool LoadRecording(Recording *recording, const char *path);
+void UnloadRecording(Recording *recording);
+
+typedef enum { REPLAY_INCOMPLETE, REPLAY_LEVEL_END, REPLAY_FAIL } ReplayOutcome;
+
+typedef struct {
+    int level;          // ENDLESS_LEVEL for an endless run
+    int stage;          // endless stage reached
+    int launches;
+    long ticks;
+    ReplayOutcome outcome;
+    int collidedA, collidedB;
+} ReplayResult;
+
+// Replays the attempt starting at records[first] (a RECORD_LEVEL_START).
+// Returns the index of the record after the attempt.
+int ReplayAttempt(const Recording *recording, int first, GameState *state, ReplayResult *result);
+
+#endif
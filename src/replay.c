@@ -0,0 +1,130 @@
+// Headless replay of a recorded session.
+//
+//   cc -O2 -o aa_replay src/replay.c src/recording.c src/game.c src/angle_index.c src/level_pack.c src/mapped_file.c -lm
+//   ./aa_replay session.aarc [repeats] [--levels pack.aalp]
+//
+// Every attempt in the recording is run through GameUpdate() with no
+// rendering and no frame cap. Prints how each attempt ended and, for
+// failures, which pin pair collided. With repeats > 1 the whole recording
+// is verified that many times to measure replay speed.
+//
+// A session played with --levels must be replayed with the same pack; the
+// recording keeps the pack's CRC and a different pack is refused.
+
+#define _POSIX_C_SOURCE 199309L
+#include "recording.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+static double Now(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+static const char *OutcomeName(ReplayOutcome outcome) {
+    switch (outcome) {
+        case REPLAY_LEVEL_END: return "level_end";
+        case REPLAY_FAIL: return "fail";
+        default: return "incomplete";
+    }
+}
+
+int main(int argc, char **argv) {
+    const char *path = NULL;
+    const char *packPath = NULL;
+    int repeats = 1;
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--levels") == 0 && i + 1 < argc) {
+            packPath = argv[++i];
+        } else if (!path) {
+            path = argv[i];
+        } else {
+            repeats = atoi(argv[i]);
+        }
+    }
+    if (!path) {
+        fprintf(stderr, "usage: %s recording [repeats] [--levels pack]\n", argv[0]);
+        return 1;
+    }
+    if (repeats < 1) repeats = 1;
+
+    Recording recording;
+    if (!LoadRecording(&recording, path)) {
+        fprintf(stderr, "%s: not a recording\n", path);
+        return 1;
+    }
+
+    LevelPack pack = {0};
+    if (packPath) {
+        if (!LoadLevelPack(&pack, packPath)) {
+            fprintf(stderr, "%s: not a level pack\n", packPath);
+            UnloadRecording(&recording);
+            return 1;
+        }
+        SetLevelPack(&pack);
+    }
+    if (recording.version < 3) {
+        fprintf(stderr, "%s: version %d recording does not name its levels, assuming they match\n", path,
+                recording.version);
+    } else if (recording.levelPack != LevelPackId(&pack)) {
+        if (recording.levelPack == RECORDING_BUILTIN_LEVELS) {
+            fprintf(stderr, "%s: recorded on the built-in levels, not a level pack\n", path);
+        } else {
+            fprintf(stderr, "%s: recorded with level pack %08x, replaying with %s\n", path,
+                    (unsigned)recording.levelPack, packPath ? packPath : "the built-in levels");
+        }
+        UnloadRecording(&recording);
+        UnloadLevelPack(&pack);
+        return 1;
+    }
+
+    static GameState state;
+    InitGameState(&state);
+
+    int attempts = 0, passed = 0, failed = 0;
+    long totalTicks = 0;
+    double start = Now();
+    for (int r = 0; r < repeats; r++) {
+        int i = 0;
+        while (i < recording.count) {
+            if (recording.records[i].kind != RECORD_LEVEL_START) {
+                i++;
+                continue;
+            }
+
+            ReplayResult result;
+            i = ReplayAttempt(&recording, i, &state, &result);
+            totalTicks += result.ticks;
+            if (r > 0) continue;
+
+            attempts++;
+            if (result.outcome == REPLAY_LEVEL_END) passed++;
+            if (result.outcome == REPLAY_FAIL) failed++;
+
+            if (result.level == ENDLESS_LEVEL) {
+                printf("endless, stage %3d: %-10s %3d launches, %6.2f s", result.stage, OutcomeName(result.outcome),
+                       result.launches, result.ticks * SIM_DT);
+            } else {
+                printf("level %3d: %-10s %3d launches, %6.2f s", result.level, OutcomeName(result.outcome),
+                       result.launches, result.ticks * SIM_DT);
+            }
+            if (result.outcome == REPLAY_FAIL) printf(", pins %d and %d collided", result.collidedA, result.collidedB);
+            printf("\n");
+        }
+    }
+    double elapsed = Now() - start;
+    double simulated = totalTicks * (double)SIM_DT;
+
+    printf("%d attempts: %d passed, %d failed, %d incomplete\n", attempts, passed, failed, attempts - passed - failed);
+    printf("replayed %.1f s of play %d times in %.4f s (%.0fx real time)\n",
+           simulated / repeats, repeats, elapsed, elapsed > 0 ? simulated / elapsed : 0.0);
+
+    UnloadRecording(&recording);
+    FreeGameState(&state);
+    SetLevelPack(NULL);
+    UnloadLevelPack(&pack);
+    return 0;
+}
@@ -0,0 +1,160 @@
+#define _POSIX_C_SOURCE 200809L
+#include "save.h"
+#include <pthread.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+#if defined(_WIN32)
+    #include <io.h>
+    #define FlushToDisk(file) _commit(_fileno(file))
+#else
+    #include <fcntl.h>
+    #include <unistd.h>
+    #define FlushToDisk(file) fsync(fileno(file))
+#endif
+
+#define SAVE_SIZE 16
+#define SAVE_TEMP_FILE SAVE_FILE ".tmp"
+
+static pthread_t writer;
+static pthread_mutex_t lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t wake = PTHREAD_COND_INITIALIZER;
+static SaveData pending;
+static bool dirty = false;
+static bool stopping = false;
+static bool running = false;
+
+static uint32_t Crc32(const unsigned char *bytes, int length) {
+    uint32_t crc = 0xFFFFFFFFu;
+    for (int i = 0; i < length; i++) {
+        crc ^= bytes[i];
+        for (int bit = 0; bit < 8; bit++) {
+            crc = (crc >> 1) ^ (0xEDB88320u & (0u - (crc & 1)));
+        }
+    }
+    return ~crc;
+}
+
+static void PutU32(unsigned char *out, uint32_t value) {
+    out[0] = value & 0xFF;
+    out[1] = (value >> 8) & 0xFF;
+    out[2] = (value >> 16) & 0xFF;
+    out[3] = (value >> 24) & 0xFF;
+}
+
+static uint32_t GetU32(const unsigned char *in) {
+    return in[0] | (in[1] << 8) | (in[2] << 16) | ((uint32_t)in[3] << 24);
+}
+
+bool LoadSave(SaveData *data) {
+    FILE *file = fopen(SAVE_FILE, "rb");
+    if (file) {
+        unsigned char bytes[SAVE_SIZE];
+        bool read = fread(bytes, 1, SAVE_SIZE, file) == SAVE_SIZE;
+        fclose(file);
+        // Levels start at 1, as in the text save; anything else is damage
+        // the CRC happened to miss, or a bad write, and is not trusted
+        uint32_t level = read ? GetU32(&bytes[8]) : 0;
+        if (read && memcmp(bytes, "AASV", 4) == 0 && bytes[4] == SAVE_VERSION &&
+            GetU32(&bytes[12]) == Crc32(bytes, 12) && level >= 1 && level <= INT32_MAX) {
+            data->highest_level_reached = (int)level;
+            return true;
+        }
+    }
+
+    // Saves from before the binary format were a single number in text
+    file = fopen(LEGACY_SAVE_FILE, "r");
+    if (file) {
+        int level;
+        bool read = fscanf(file, "%d", &level) == 1 && level >= 1;
+        fclose(file);
+        if (read) {
+            data->highest_level_reached = level;
+            return true;
+        }
+    }
+    return false;
+}
+
+// Makes the rename itself durable: until the directory entry reaches the
+// disk, a crash can bring back the old save or none at all
+static void SyncSaveDirectory(void) {
+#if !defined(_WIN32)
+    int dir = open(".", O_RDONLY);
+    if (dir < 0) return;
+    fsync(dir);
+    close(dir);
+#endif
+}
+
+static bool WriteSave(const SaveData *data) {
+    unsigned char bytes[SAVE_SIZE] = { 'A', 'A', 'S', 'V', SAVE_VERSION, 0, 0, 0 };
+    PutU32(&bytes[8], (uint32_t)data->highest_level_reached);
+    PutU32(&bytes[12], Crc32(bytes, 12));
+
+    FILE *file = fopen(SAVE_TEMP_FILE, "wb");
+    if (!file) return false;
+    bool ok = fwrite(bytes, 1, SAVE_SIZE, file) == SAVE_SIZE;
+    ok = fflush(file) == 0 && ok;
+    ok = FlushToDisk(file) == 0 && ok;
+    ok = fclose(file) == 0 && ok;
+    if (!ok) {
+        remove(SAVE_TEMP_FILE);
+        return false;
+    }
+#if defined(_WIN32)
+    // rename() does not replace an existing file on Windows
+    remove(SAVE_FILE);
+#endif
+    if (rename(SAVE_TEMP_FILE, SAVE_FILE) != 0) return false;
+    SyncSaveDirectory();
+    return true;
+}
+
+static void *WriterMain(void *arg) {
+    (void)arg;
+    pthread_mutex_lock(&lock);
+    for (;;) {
+        while (!dirty && !stopping) pthread_cond_wait(&wake, &lock);
+        if (!dirty && stopping) break;
+
+        // Only the latest data is written, however many requests came in
+        SaveData data = pending;
+        dirty = false;
+        pthread_mutex_unlock(&lock);
+        WriteSave(&data);
+        pthread_mutex_lock(&lock);
+    }
+    pthread_mutex_unlock(&lock);
+    return NULL;
+}
+
+void InitSaveSystem(void) {
+    if (running) return;
+    dirty = false;
+    stopping = false;
+    running = pthread_create(&writer, NULL, WriterMain, NULL) == 0;
+}
+
+void RequestSave(const SaveData *data) {
+    if (!running) {
+        WriteSave(data);
+        return;
+    }
+    pthread_mutex_lock(&lock);
+    pending = *data;
+    dirty = true;
+    pthread_cond_signal(&wake);
+    pthread_mutex_unlock(&lock);
+}
+
+void CloseSaveSystem(void) {
+    if (!running) return;
+    pthread_mutex_lock(&lock);
+    stopping = true;
+    pthread_cond_signal(&wake);
+    pthread_mutex_unlock(&lock);
+    pthread_join(writer, NULL);
+    running = false;
+}
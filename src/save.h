@@ -0,0 +1,29 @@
+#ifndef SAVE_H
+#define SAVE_H
+
+#include <stdbool.h>
+
+// Saves are 16 bytes: "AASV", version, reserved, the highest level
+// reached and a CRC-32 of the first 12 bytes, all little-endian.
+#define SAVE_FILE "save_file.bin"
+#define LEGACY_SAVE_FILE "save_file.txt"
+#define SAVE_VERSION 1
+
+typedef struct {
+    int highest_level_reached;
+} SaveData;
+
+// Reads SAVE_FILE, falling back to the old text save when it is missing,
+// damaged or holds a level below 1. Leaves data untouched when neither
+// can be read.
+bool LoadSave(SaveData *data);
+
+// Progress is written by a background thread. RequestSave() only copies
+// the data and wakes the writer, which coalesces requests and replaces the
+// file atomically (write temp file, fsync, rename, fsync the directory).
+void InitSaveSystem(void);
+void RequestSave(const SaveData *data);
+// Writes anything still pending and stops the writer thread
+void CloseSaveSystem(void);
+
+#endif
@@ -0,0 +1,321 @@
+#define _POSIX_C_SOURCE 199309L
+#include "sim_thread.h"
+#include "profiler.h"
+#include "telemetry.h"
+#include <math.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include <string.h>
+#include <time.h>
+
+#define COMMAND_QUEUE_SIZE 64
+// A longer stall is dropped rather than caught up on
+#define MAX_STALL 0.25
+
+typedef enum {
+    SIM_COMMAND_START,
+    SIM_COMMAND_LAUNCH,
+} SimCommandType;
+
+typedef struct {
+    SimCommandType type;
+    int level;
+    int attempt;
+    double time;
+} SimCommand;
+
+// Single producer (render thread), single consumer (simulation thread)
+typedef struct {
+    SimCommand items[COMMAND_QUEUE_SIZE];
+    atomic_uint head;
+    atomic_uint tail;
+} CommandQueue;
+
+static CommandQueue commands;
+static pthread_t thread;
+static bool started = false;
+static atomic_bool running;
+// Only used to sleep while idle, never while publishing or reading
+static pthread_mutex_t lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t wake = PTHREAD_COND_INITIALIZER;
+static double (*Clock)(void);
+static Recorder *recorder;
+static int nextAttempt = 0;
+
+// Triple buffer. The simulation fills slots[back] and swaps it into
+// middle; the renderer swaps middle with slots[front] when it holds a
+// snapshot the renderer has not seen yet.
+#define SNAPSHOT_FRESH 4
+static GameSnapshot slots[3];
+static atomic_int middle;
+static int back = 1;
+static int front = 2;
+
+// Owned by the simulation thread
+static GameState state;
+static PinSet prevPins;
+static int attempt = 0;
+static SimStatus status = SIM_IDLE;
+static double simClock = 0;
+static double launchQueue[SIM_LAUNCH_HISTORY];
+static int launchesQueued = 0;
+static long lastLaunchStep = -1;
+static unsigned int launches, attaches, collisions;
+static long collisionTick;
+static double launchPress[SIM_LAUNCH_HISTORY];
+
+static bool PushCommand(SimCommand command) {
+    unsigned int tail = atomic_load_explicit(&commands.tail, memory_order_relaxed);
+    unsigned int head = atomic_load_explicit(&commands.head, memory_order_acquire);
+    if (tail - head == COMMAND_QUEUE_SIZE) return false;
+    commands.items[tail % COMMAND_QUEUE_SIZE] = command;
+    atomic_store_explicit(&commands.tail, tail + 1, memory_order_release);
+
+    pthread_mutex_lock(&lock);
+    pthread_cond_signal(&wake);
+    pthread_mutex_unlock(&lock);
+    return true;
+}
+
+static bool PopCommand(SimCommand *command) {
+    unsigned int head = atomic_load_explicit(&commands.head, memory_order_relaxed);
+    unsigned int tail = atomic_load_explicit(&commands.tail, memory_order_acquire);
+    if (head == tail) return false;
+    *command = commands.items[head % COMMAND_QUEUE_SIZE];
+    atomic_store_explicit(&commands.head, head + 1, memory_order_release);
+    return true;
+}
+
+static bool QueueEmpty(void) {
+    return atomic_load(&commands.head) == atomic_load(&commands.tail);
+}
+
+static void Publish(void) {
+    GameSnapshot *snapshot = &slots[back];
+    snapshot->attempt = attempt;
+    snapshot->status = status;
+    snapshot->level = state.current_level;
+    snapshot->level_pin = state.level_pin;
+    snapshot->stage = state.stage;
+    snapshot->rings = state.rings;
+    snapshot->tick = state.tick;
+    snapshot->gameOver = state.gameOver;
+    snapshot->failTriggered = state.failTriggered;
+    snapshot->collidedA = state.collidedA;
+    snapshot->collidedB = state.collidedB;
+    snapshot->time = simClock;
+    CopyPins(&snapshot->prev, &prevPins);
+    CopyPins(&snapshot->pins, &state.pins);
+    snapshot->launches = launches;
+    snapshot->attaches = attaches;
+    snapshot->collisions = collisions;
+    memcpy(snapshot->launchPress, launchPress, sizeof(launchPress));
+
+    int old = atomic_exchange_explicit(&middle, back | SNAPSHOT_FRESH, memory_order_acq_rel);
+    back = old & 3;
+}
+
+const GameSnapshot *SimLatestSnapshot(void) {
+    if (atomic_load_explicit(&middle, memory_order_acquire) & SNAPSHOT_FRESH) {
+        int old = atomic_exchange_explicit(&middle, front, memory_order_acq_rel);
+        front = old & 3;
+    }
+    return &slots[front];
+}
+
+// Places a press in the step it happened in. The step about to run starts
+// at simClock; a press from before that goes into an earlier step through
+// launchLag. Presses that cannot be placed exactly launch at the start of
+// the earliest step still free.
+static GameInput LaunchInput(double pressTime) {
+    GameInput input = { .launch = true };
+    double phase = (pressTime - simClock) / SIM_DT;
+    long lag = 0;
+    if (phase < 0) {
+        lag = (long)ceil(-phase);
+        phase += lag;
+    }
+    // Not before the last launch's step, nor before the stage started: a
+    // launch reaching back into the previous stage would be recorded in it
+    long earliest = lastLaunchStep + 1 > state.stageStartTick ? lastLaunchStep + 1 : state.stageStartTick;
+    if (state.tick - lag < earliest) {
+        lag = state.tick - earliest;
+        phase = 0;
+    }
+    if (lag > GAME_MAX_LAUNCH_LAG) {
+        lag = 0;
+        phase = 0;
+    }
+
+    int subtick = (int)(phase * GAME_SUBTICKS);
+    input.launchSubtick = subtick > GAME_SUBTICKS - 1 ? GAME_SUBTICKS - 1 : subtick;
+    input.launchLag = (uint8_t)lag;
+    return input;
+}
+
+static int AttemptLevel(void) {
+    return state.endless ? ENDLESS_LEVEL : state.current_level;
+}
+
+static void AddAttemptEnd(TelemetryOutcome outcome, long tick) {
+    TelemetryRecord record = {
+        .kind = TELEMETRY_ATTEMPT_END,
+        .outcome = outcome,
+        .level = (uint16_t)AttemptLevel(),
+        .attempt = (uint32_t)attempt,
+        .tick = (uint32_t)tick,
+        .a = (int16_t)(launches > INT16_MAX ? INT16_MAX : launches),
+        .x = tick * SIM_DT,
+    };
+    TelemetryAdd(&record);
+}
+
+static void Step(void) {
+    CopyPins(&prevPins, &state.pins);
+
+    GameInput input = {0};
+    double pressTime = 0;
+    if (launchesQueued > 0 && launchQueue[0] < simClock + SIM_DT) {
+        pressTime = launchQueue[0];
+        input = LaunchInput(pressTime);
+        launchesQueued--;
+        memmove(launchQueue, launchQueue + 1, launchesQueued * sizeof(double));
+    }
+    simClock += SIM_DT;
+
+    long step = state.tick - input.launchLag;
+    int events = GameUpdate(&state, input);
+    if (events & GAME_EVENT_LAUNCH) {
+        int level = AttemptLevel();
+        RecorderAdd(recorder, RECORD_LAUNCH, step, level, input.launchSubtick);
+        TelemetryAdd(&(TelemetryRecord){ .kind = TELEMETRY_LAUNCH, .level = (uint16_t)level, .attempt = (uint32_t)attempt,
+                                         .tick = (uint32_t)step, .a = input.launchSubtick });
+        lastLaunchStep = step;
+        launchPress[launches % SIM_LAUNCH_HISTORY] = pressTime;
+        launches++;
+    }
+    if (events & GAME_EVENT_ATTACH) attaches++;
+    if (events & GAME_EVENT_COLLISION) {
+        collisions++;
+        collisionTick = state.tick;
+        TelemetryRecord record = {
+            .kind = TELEMETRY_COLLISION,
+            .level = (uint16_t)AttemptLevel(),
+            .attempt = (uint32_t)attempt,
+            .tick = (uint32_t)state.tick,
+            .a = (int16_t)state.collidedA,
+            .b = (int16_t)state.collidedB,
+            .x = AngleToDegrees(BoardRelativeAngle(state.boardAngle, state.pins.angle[state.collidedB])),
+        };
+        TelemetryAdd(&record);
+    }
+    if (events & GAME_EVENT_LEVEL_PASSED) {
+        status = SIM_PASSED;
+        AddAttemptEnd(TELEMETRY_PASSED, state.tick);
+    }
+    if (events & GAME_EVENT_FAIL) {
+        status = SIM_FAILED;
+        // Timed to the collision rather than the end of the fail timer
+        AddAttemptEnd(TELEMETRY_FAILED, collisionTick);
+    }
+}
+
+static void HandleCommand(const SimCommand *command) {
+    switch (command->type) {
+        case SIM_COMMAND_START:
+            if (status == SIM_PLAYING) AddAttemptEnd(TELEMETRY_ABANDONED, state.tick);
+            if (command->level == ENDLESS_LEVEL) {
+                StartEndless(&state);
+            } else {
+                StartLevel(&state, command->level);
+            }
+            RecorderAdd(recorder, RECORD_LEVEL_START, 0, command->level, 0);
+            attempt = command->attempt;
+            status = SIM_PLAYING;
+            TelemetryAdd(&(TelemetryRecord){ .kind = TELEMETRY_ATTEMPT_START, .level = (uint16_t)command->level,
+                                             .attempt = (uint32_t)attempt });
+            simClock = Clock();
+            prevPins.count = 0;
+            launchesQueued = 0;
+            lastLaunchStep = -1;
+            launches = attaches = collisions = 0;
+            Publish();
+            break;
+        case SIM_COMMAND_LAUNCH:
+            if (status == SIM_PLAYING && launchesQueued < SIM_LAUNCH_HISTORY) {
+                launchQueue[launchesQueued++] = command->time;
+            }
+            break;
+    }
+}
+
+static void SleepUntil(double deadline) {
+    double wait = deadline - Clock();
+    if (wait <= 0) return;
+    struct timespec ts = { (time_t)wait, (long)((wait - (time_t)wait) * 1e9) };
+    nanosleep(&ts, NULL);
+}
+
+static void *SimThreadMain(void *arg) {
+    (void)arg;
+    while (atomic_load(&running)) {
+        SimCommand command;
+        while (PopCommand(&command)) HandleCommand(&command);
+
+        if (status != SIM_PLAYING) {
+            pthread_mutex_lock(&lock);
+            while (atomic_load(&running) && QueueEmpty()) pthread_cond_wait(&wake, &lock);
+            pthread_mutex_unlock(&lock);
+            continue;
+        }
+
+        double now = Clock();
+        if (now - simClock > MAX_STALL) simClock = now - MAX_STALL;
+        if (simClock + SIM_DT <= now) {
+            PROFILE_BEGIN(PROFILE_SIMULATION);
+            while (status == SIM_PLAYING && simClock + SIM_DT <= now) Step();
+            PROFILE_END(PROFILE_SIMULATION);
+            Publish();
+        }
+        if (status == SIM_PLAYING) SleepUntil(simClock + SIM_DT);
+    }
+    return NULL;
+}
+
+bool StartSimThread(double (*clock)(void), Recorder *levelRecorder) {
+    Clock = clock;
+    recorder = levelRecorder;
+    InitGameState(&state);
+    atomic_store(&middle, 0);
+    atomic_store(&running, true);
+    started = pthread_create(&thread, NULL, SimThreadMain, NULL) == 0;
+    return started;
+}
+
+void StopSimThread(void) {
+    if (!started) return;
+    pthread_mutex_lock(&lock);
+    atomic_store(&running, false);
+    pthread_cond_signal(&wake);
+    pthread_mutex_unlock(&lock);
+    pthread_join(thread, NULL);
+    started = false;
+    if (status == SIM_PLAYING) AddAttemptEnd(TELEMETRY_ABANDONED, state.tick);
+    status = SIM_IDLE;
+    FreeGameState(&state);
+    FreePins(&prevPins);
+    for (int i = 0; i < 3; i++) {
+        FreePins(&slots[i].prev);
+        FreePins(&slots[i].pins);
+    }
+}
+
+int SimStartLevel(int level) {
+    int id = ++nextAttempt;
+    PushCommand((SimCommand){ .type = SIM_COMMAND_START, .level = level, .attempt = id });
+    return id;
+}
+
+void SimLaunch(double pressTime) {
+    PushCommand((SimCommand){ .type = SIM_COMMAND_LAUNCH, .time = pressTime });
+}
@@ -0,0 +1,65 @@
+#ifndef SIM_THREAD_H
+#define SIM_THREAD_H
+
+#include "game.h"
+#include "recording.h"
+
+// The game scene is simulated on its own thread at SIM_HZ, so a slow frame
+// or a vsync stall on the render thread does not hold up pin updates and
+// collision checks. The render thread sends commands through a lock-free
+// queue and reads the latest published snapshot; neither waits for the
+// other.
+
+#define SIM_LAUNCH_HISTORY 16
+
+typedef enum {
+    SIM_IDLE,
+    SIM_PLAYING,
+    SIM_PASSED,     // the level was passed, the thread is idle again
+    SIM_FAILED,     // the fail timer ran out, the thread is idle again
+} SimStatus;
+
+// The game state after a step. Snapshots are immutable once published.
+typedef struct {
+    int attempt;            // SimStartLevel() call this belongs to
+    SimStatus status;
+    int level;
+    int level_pin;
+    int stage;              // endless mode only, 0 otherwise
+    int rings;
+    long tick;
+    bool gameOver;
+    bool failTriggered;
+    int collidedA, collidedB;
+    // Clock time the latest step ended at, and the pins before and after
+    // it, for render interpolation
+    double time;
+    PinSet prev;
+    PinSet pins;
+    // Steps with these events since the level started, so a reader that
+    // skips snapshots still sees every one
+    unsigned int launches;
+    unsigned int attaches;
+    unsigned int collisions;
+    // Press time of launch n is at launchPress[n % SIM_LAUNCH_HISTORY]
+    double launchPress[SIM_LAUNCH_HISTORY];
+} GameSnapshot;
+
+// clock must be callable from any thread and is the time base for press
+// times. Launches are recorded to recorder when it is open; it must not be
+// used elsewhere until StopSimThread().
+bool StartSimThread(double (*clock)(void), Recorder *recorder);
+void StopSimThread(void);
+
+// Returns the attempt number that snapshots of the new level carry.
+// ENDLESS_LEVEL starts an endless run.
+int SimStartLevel(int level);
+// A launch pressed at pressTime. It lands in the step that contains
+// pressTime even if that step was already simulated, up to
+// GAME_MAX_LAUNCH_LAG steps back.
+void SimLaunch(double pressTime);
+
+// The latest snapshot. It stays valid and unchanged until the next call.
+const GameSnapshot *SimLatestSnapshot(void);
+
+#endif
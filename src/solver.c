@@ -0,0 +1,318 @@
+// Level solver and solvability table.
+//
+//   cc -O2 -pthread -o aa_solver src/solver.c src/game.c src/angle_index.c src/level_pack.c src/mapped_file.c -lm
+//   ./aa_solver [levels] [node budget per level] [threads] [level pack]
+//
+// Attached pins only collide at the moment a new pin attaches, and the
+// board rotation depends only on the level and the step number. So a
+// launch at step t is safe exactly when the board-relative angle the pin
+// will attach at is clear in the angle index. For each pin the solver scans
+// one full turn of launch steps, groups the safe ones into windows and
+// searches them depth-first, launching at the leading edge of each window
+// before trying its centre. Over all solutions found it keeps the one
+// whose narrowest window is widest, which says how forgiving the level can
+// be played, and replays it through GameUpdate() to confirm it against the
+// real game.
+//
+// Levels are spread over the cores by a small work-stealing pool: every
+// worker owns a deque of levels, pops from its own end and steals from the
+// other end of a neighbour's deque when it runs dry.
+
+#define _POSIX_C_SOURCE 200809L
+#include "game.h"
+#include <math.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+// Longest wait considered between two launches: one full turn at speed 1
+#define MAX_WAIT 360
+#define MAX_WINDOWS 64
+#define MAX_WORKERS 64
+
+typedef struct {
+    int start, width;   // launch steps relative to the earliest allowed one
+} Window;
+
+typedef struct {
+    int level;
+    int pins;           // pins to launch
+    long nodes;
+    long solutions;
+    bool budgetHit;
+    bool solved;
+    bool verified;
+    // Widest narrowest window over the solutions found, in steps. Only a
+    // lower bound when the budget ran out.
+    int bestWindow;
+    double seconds;
+} LevelResult;
+
+typedef struct {
+    int level;
+    int toLaunch;
+    int attachSteps;
+    long nodeBudget;
+    BinaryAngle *relAngle;  // board-relative attach angle for a launch at step t
+    long horizon;
+    long launches[MAX_RING_PINS];
+    long bestSolution[MAX_RING_PINS];
+    LevelResult *result;
+} Search;
+
+static double Now(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+// Steps from launch until a pin attaches, as GameUpdate() moves it
+static int AttachSteps(void) {
+    float y = PIN_LAUNCH_OFFSET;
+    int steps = 0;
+    do {
+        y -= PIN_SPEED;
+        steps++;
+    } while (y > ATTACH_RADIUS);
+    return steps;
+}
+
+static int FindWindows(const Search *search, const AngleIndex *index, long first, Window windows[MAX_WINDOWS]) {
+    int count = 0;
+    int hits[2];
+    for (int d = 0; d < MAX_WAIT && first + d < search->horizon; d++) {
+        bool safe = AngleIndexFindNear(index, search->relAngle[first + d], COLLISION_ANGLE, hits) == 0;
+        if (!safe) continue;
+        if (count > 0 && windows[count - 1].start + windows[count - 1].width == d) {
+            windows[count - 1].width++;
+        } else if (count < MAX_WINDOWS) {
+            windows[count++] = (Window){ d, 1 };
+        }
+    }
+
+    return count;
+}
+
+static void Solve(Search *search, const AngleIndex *index, int launched, long first, int narrowest) {
+    LevelResult *result = search->result;
+    if (result->nodes >= search->nodeBudget) {
+        result->budgetHit = true;
+        return;
+    }
+    result->nodes++;
+
+    if (launched == search->toLaunch) {
+        if (!result->solved || narrowest > result->bestWindow) {
+            result->solved = true;
+            result->bestWindow = narrowest;
+            memcpy(search->bestSolution, search->launches, sizeof(search->launches));
+        }
+        result->solutions++;
+        return;
+    }
+
+    // Try every window at its leading edge first, which packs pins tightly
+    // against their neighbours, then at its centre
+    Window windows[MAX_WINDOWS];
+    int count = FindWindows(search, index, first, windows);
+    for (int c = 0; c < 2 * count; c++) {
+        int w = c % count;
+        if (c >= count && windows[w].width < 3) continue;
+        long t = first + windows[w].start + (c < count ? 0 : windows[w].width / 2);
+        search->launches[launched] = t;
+
+        AngleIndex next = *index;
+        AngleIndexInsert(&next, search->relAngle[t], -1);
+        int width = windows[w].width < narrowest ? windows[w].width : narrowest;
+        Solve(search, &next, launched + 1, t + 1, width);
+        if (result->budgetHit) return;
+    }
+}
+
+// Runs the best solution through the real game update
+static bool Verify(const Search *search, GameState *state) {
+    StartLevel(state, search->level);
+    int next = 0;
+    long limit = search->bestSolution[search->toLaunch - 1] + 2 * SIM_HZ;
+    while (state->tick <= limit) {
+        GameInput input = { .launch = next < search->toLaunch && search->bestSolution[next] == state->tick };
+        if (input.launch) next++;
+        int events = GameUpdate(state, input);
+        if (events & GAME_EVENT_LEVEL_PASSED) return true;
+        if (events & (GAME_EVENT_COLLISION | GAME_EVENT_FAIL)) return false;
+    }
+    return false;
+}
+
+static void SolveLevel(int level, long nodeBudget, LevelResult *result) {
+    double start = Now();
+    GameState *state = malloc(sizeof(GameState));
+    Search *search = malloc(sizeof(Search));
+    InitGameState(state);
+    StartLevel(state, level);
+
+    memset(result, 0, sizeof(*result));
+    result->level = level;
+    result->pins = state->level_pin - state->pins.count;
+
+    search->level = level;
+    search->toLaunch = result->pins;
+    search->attachSteps = AttachSteps();
+    search->nodeBudget = nodeBudget;
+    search->result = result;
+    search->horizon = (long)(search->toLaunch + 1) * MAX_WAIT;
+    search->relAngle = malloc(search->horizon * sizeof(BinaryAngle));
+
+    // Replay the board rotation exactly as GameUpdate() accumulates it
+    long steps = search->horizon + search->attachSteps;
+    BinaryAngle boardAngle = 0;
+    for (long tick = 1; tick <= steps; tick++) {
+        boardAngle += DegreesToAngle(LevelRotationStep(&state->levelRecord, tick));
+        long launch = tick - search->attachSteps;
+        if (launch >= 0 && launch < search->horizon) {
+            search->relAngle[launch] = BoardRelativeAngle(boardAngle, LAUNCH_ANGLE);
+        }
+    }
+
+    if (search->toLaunch <= 0) {
+        result->solved = result->verified = true;
+        result->solutions = 1;
+    } else if (state->level_pin > MAX_RING_PINS) {
+        // More pins than fit around the core, no need to search
+    } else {
+        Solve(search, &state->attachedIndex, 0, 0, MAX_WAIT);
+        if (result->solved) result->verified = Verify(search, state);
+    }
+
+    result->seconds = Now() - start;
+    free(search->relAngle);
+    free(search);
+    FreeGameState(state);
+    free(state);
+}
+
+typedef struct {
+    pthread_mutex_t lock;
+    int *levels;
+    int head, tail;     // owner pops at tail, thieves take from head
+} WorkDeque;
+
+typedef struct {
+    WorkDeque deques[MAX_WORKERS];
+    int workers;
+    long nodeBudget;
+    LevelResult *results;
+} Pool;
+
+typedef struct {
+    Pool *pool;
+    int id;
+} Worker;
+
+static bool PopLocal(WorkDeque *deque, int *level) {
+    pthread_mutex_lock(&deque->lock);
+    bool ok = deque->tail > deque->head;
+    if (ok) *level = deque->levels[--deque->tail];
+    pthread_mutex_unlock(&deque->lock);
+    return ok;
+}
+
+static bool Steal(WorkDeque *deque, int *level) {
+    pthread_mutex_lock(&deque->lock);
+    bool ok = deque->tail > deque->head;
+    if (ok) *level = deque->levels[deque->head++];
+    pthread_mutex_unlock(&deque->lock);
+    return ok;
+}
+
+static void *WorkerMain(void *arg) {
+    Worker *worker = arg;
+    Pool *pool = worker->pool;
+    for (;;) {
+        int level;
+        bool found = PopLocal(&pool->deques[worker->id], &level);
+        for (int i = 1; !found && i < pool->workers; i++) {
+            found = Steal(&pool->deques[(worker->id + i) % pool->workers], &level);
+        }
+        // Levels are only handed out up front, so empty everywhere means done
+        if (!found) return NULL;
+        SolveLevel(level, pool->nodeBudget, &pool->results[level - 1]);
+    }
+}
+
+int main(int argc, char **argv) {
+    int levels = (argc > 1) ? atoi(argv[1]) : 40;
+    long nodeBudget = (argc > 2) ? atol(argv[2]) : 200000;
+    int workers = (argc > 3) ? atoi(argv[3]) : (int)sysconf(_SC_NPROCESSORS_ONLN);
+    if (levels < 1) levels = 1;
+    if (workers < 1) workers = 1;
+    if (workers > MAX_WORKERS) workers = MAX_WORKERS;
+
+    LevelPack pack;
+    if (argc > 4) {
+        if (!LoadLevelPack(&pack, argv[4])) {
+            fprintf(stderr, "%s: not a level pack\n", argv[4]);
+            return 1;
+        }
+        SetLevelPack(&pack);
+    }
+
+    static Pool pool;
+    pool.workers = workers;
+    pool.nodeBudget = nodeBudget;
+    pool.results = calloc(levels, sizeof(LevelResult));
+    for (int w = 0; w < workers; w++) {
+        pthread_mutex_init(&pool.deques[w].lock, NULL);
+        pool.deques[w].levels = malloc(levels * sizeof(int));
+    }
+    // Deal levels round-robin; owners start from their hardest level
+    for (int level = 1; level <= levels; level++) {
+        WorkDeque *deque = &pool.deques[(level - 1) % workers];
+        deque->levels[deque->tail++] = level;
+    }
+
+    double start = Now();
+    pthread_t threads[MAX_WORKERS];
+    Worker args[MAX_WORKERS];
+    for (int w = 0; w < workers; w++) {
+        args[w] = (Worker){ &pool, w };
+        pthread_create(&threads[w], NULL, WorkerMain, &args[w]);
+    }
+    for (int w = 0; w < workers; w++) pthread_join(threads[w], NULL);
+    double elapsed = Now() - start;
+
+    printf("%6s %5s %9s %12s %10s %10s %9s\n", "level", "pins", "solvable", "best window", "solutions", "nodes", "time");
+    int solvable = 0, unsolvable = 0, unknown = 0;
+    for (int i = 0; i < levels; i++) {
+        LevelResult *r = &pool.results[i];
+        const char *status = !r->solved ? (r->budgetHit ? "unknown" : "no") : (r->verified ? "yes" : "MISMATCH");
+        if (r->solved) {
+            solvable++;
+        } else if (r->budgetHit) {
+            unknown++;
+        } else {
+            unsolvable++;
+        }
+        char window[32] = "-";
+        if (r->solved && r->pins > 0) {
+            snprintf(window, sizeof(window), "%s%.0f ms", r->budgetHit ? ">=" : "", r->bestWindow * 1000.0 / SIM_HZ);
+        }
+        printf("%6d %5d %9s %12s %9s%ld %10ld %7.1fms\n", r->level, r->pins, status, window,
+               r->budgetHit ? ">=" : "  ", r->solutions, r->nodes, r->seconds * 1000.0);
+    }
+    printf("%d levels on %d threads in %.3f s: %d solvable, %d unsolvable, %d unknown\n", levels, workers, elapsed,
+           solvable, unsolvable, unknown);
+    // Levels the node budget ran out on before a solution was found
+    if (unknown > 0) {
+        printf("unknown (node budget of %ld hit):", nodeBudget);
+        for (int i = 0; i < levels; i++) {
+            LevelResult *r = &pool.results[i];
+            if (!r->solved && r->budgetHit) printf(" %d", r->level);
+        }
+        printf("\n");
+    }
+    return 0;
+}
@@ -0,0 +1,252 @@
+#define _POSIX_C_SOURCE 200809L
+#include "telemetry.h"
+#include <pthread.h>
+#include <sched.h>
+#include <stdatomic.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <time.h>
+
+#define WRITE_BATCH 512
+// How often the writer wakes to drain the ring
+#define WRITE_INTERVAL_NS 100000000L
+
+// Bounded multi-producer ring. Every slot carries a sequence number: equal
+// to the position when the slot is free for that position, one more once
+// the record for it is written.
+typedef struct {
+    atomic_uint sequence;
+    TelemetryRecord record;
+} TelemetrySlot;
+
+static TelemetrySlot ring[TELEMETRY_RING_SIZE];
+static atomic_uint tail;
+static unsigned int head;              // writer thread only
+static atomic_long dropped;
+static atomic_bool enabled = false;
+// TelemetryAdd() calls past the enabled check, which StopTelemetry() waits
+// out before the last drain
+static atomic_int adding;
+static atomic_bool running;
+static pthread_t writer;
+
+static char prefix[256];
+static int fileIndex;
+static long fileSize;
+static FILE *file;
+
+static void PutU16(unsigned char *out, uint16_t v) {
+    out[0] = v & 0xFF;
+    out[1] = (v >> 8) & 0xFF;
+}
+
+static void PutU32(unsigned char *out, uint32_t v) {
+    for (int i = 0; i < 4; i++) out[i] = (v >> (8 * i)) & 0xFF;
+}
+
+static uint32_t GetU32(const unsigned char *in) {
+    return in[0] | (in[1] << 8) | (in[2] << 16) | ((uint32_t)in[3] << 24);
+}
+
+void EncodeTelemetryRecord(unsigned char *out, const TelemetryRecord *record) {
+    uint32_t x, y;
+    memcpy(&x, &record->x, 4);
+    memcpy(&y, &record->y, 4);
+    out[0] = record->kind;
+    out[1] = record->outcome;
+    PutU16(out + 2, record->level);
+    PutU32(out + 4, record->attempt);
+    PutU32(out + 8, record->tick);
+    PutU16(out + 12, (uint16_t)record->a);
+    PutU16(out + 14, (uint16_t)record->b);
+    PutU32(out + 16, x);
+    PutU32(out + 20, y);
+}
+
+TelemetryRecord DecodeTelemetryRecord(const unsigned char *in) {
+    TelemetryRecord record;
+    record.kind = in[0];
+    record.outcome = in[1];
+    record.level = in[2] | (in[3] << 8);
+    record.attempt = GetU32(in + 4);
+    record.tick = GetU32(in + 8);
+    record.a = (int16_t)(in[12] | (in[13] << 8));
+    record.b = (int16_t)(in[14] | (in[15] << 8));
+    uint32_t x = GetU32(in + 16), y = GetU32(in + 20);
+    memcpy(&record.x, &x, 4);
+    memcpy(&record.y, &y, 4);
+    return record;
+}
+
+static bool Add(const TelemetryRecord *record) {
+    unsigned int pos = atomic_load_explicit(&tail, memory_order_relaxed);
+    TelemetrySlot *slot;
+    for (;;) {
+        slot = &ring[pos % TELEMETRY_RING_SIZE];
+        unsigned int sequence = atomic_load_explicit(&slot->sequence, memory_order_acquire);
+        int diff = (int)(sequence - pos);
+        if (diff == 0) {
+            if (atomic_compare_exchange_weak_explicit(&tail, &pos, pos + 1, memory_order_relaxed, memory_order_relaxed)) break;
+        } else if (diff < 0) {
+            atomic_fetch_add_explicit(&dropped, 1, memory_order_relaxed);
+            return false;
+        } else {
+            pos = atomic_load_explicit(&tail, memory_order_relaxed);
+        }
+    }
+    slot->record = *record;
+    atomic_store_explicit(&slot->sequence, pos + 1, memory_order_release);
+    return true;
+}
+
+bool TelemetryAdd(const TelemetryRecord *record) {
+    if (!atomic_load_explicit(&enabled, memory_order_relaxed)) return false;
+
+    // Sequentially consistent with StopTelemetry(): either it sees this
+    // call in progress and waits, or this call sees telemetry stopped
+    atomic_fetch_add(&adding, 1);
+    bool added = atomic_load(&enabled) && Add(record);
+    atomic_fetch_sub_explicit(&adding, 1, memory_order_release);
+    return added;
+}
+
+long GetTelemetryDropped(void) {
+    return atomic_load(&dropped);
+}
+
+static int Take(TelemetryRecord *records, int capacity) {
+    int count = 0;
+    while (count < capacity) {
+        TelemetrySlot *slot = &ring[head % TELEMETRY_RING_SIZE];
+        if (atomic_load_explicit(&slot->sequence, memory_order_acquire) != head + 1) break;
+        records[count++] = slot->record;
+        atomic_store_explicit(&slot->sequence, head + TELEMETRY_RING_SIZE, memory_order_release);
+        head++;
+    }
+    return count;
+}
+
+static void LogPath(char *path, size_t size, int index) {
+    snprintf(path, size, "%s-%03d.aatl", prefix, index);
+}
+
+// Opens log index for appending, or from empty when truncate is set
+static bool OpenLog(int index, bool truncate) {
+    char path[300];
+    LogPath(path, sizeof(path), index);
+    file = fopen(path, truncate ? "wb" : "ab");
+    if (!file) return false;
+    fileIndex = index;
+    fseek(file, 0, SEEK_END);
+    fileSize = ftell(file);
+    if (fileSize == 0) {
+        unsigned char header[16] = { 'A', 'A', 'T', 'L', TELEMETRY_VERSION, TELEMETRY_RECORD_SIZE };
+        fwrite(header, 1, sizeof(header), file);
+        fileSize = sizeof(header);
+    }
+    return true;
+}
+
+static void WriteBatch(const TelemetryRecord *records, int count) {
+    static unsigned char bytes[WRITE_BATCH * TELEMETRY_RECORD_SIZE];
+    if (!file) return;
+    if (fileSize >= TELEMETRY_FILE_LIMIT) {
+        fclose(file);
+        if (!OpenLog((fileIndex + 1) % TELEMETRY_MAX_FILES, true)) return;
+    }
+    for (int i = 0; i < count; i++) EncodeTelemetryRecord(&bytes[i * TELEMETRY_RECORD_SIZE], &records[i]);
+    fileSize += (long)fwrite(bytes, TELEMETRY_RECORD_SIZE, count, file) * TELEMETRY_RECORD_SIZE;
+    fflush(file);
+}
+
+static void *WriterMain(void *arg) {
+    (void)arg;
+    static TelemetryRecord batch[WRITE_BATCH];
+    for (;;) {
+        // Checked before draining so the last pass still empties the ring
+        bool stopping = !atomic_load(&running);
+        int count;
+        while ((count = Take(batch, WRITE_BATCH)) > 0) WriteBatch(batch, count);
+        if (stopping) return NULL;
+
+        struct timespec ts = { 0, WRITE_INTERVAL_NS };
+        nanosleep(&ts, NULL);
+    }
+}
+
+bool StartTelemetry(const char *logPrefix) {
+    if (atomic_load(&enabled)) return true;
+    snprintf(prefix, sizeof(prefix), "%s", logPrefix);
+
+    // Carry on with the most recently written log
+    int latest = 0;
+    time_t latestTime = 0;
+    for (int i = 0; i < TELEMETRY_MAX_FILES; i++) {
+        char path[300];
+        struct stat info;
+        LogPath(path, sizeof(path), i);
+        if (stat(path, &info) == 0 && info.st_mtime > latestTime) {
+            latest = i;
+            latestTime = info.st_mtime;
+        }
+    }
+    if (!OpenLog(latest, false)) return false;
+
+    for (unsigned int i = 0; i < TELEMETRY_RING_SIZE; i++) atomic_store(&ring[i].sequence, i);
+    atomic_store(&tail, 0);
+    head = 0;
+    atomic_store(&running, true);
+    if (pthread_create(&writer, NULL, WriterMain, NULL) != 0) {
+        fclose(file);
+        file = NULL;
+        return false;
+    }
+    atomic_store(&enabled, true);
+    return true;
+}
+
+void StopTelemetry(void) {
+    if (!atomic_load(&enabled)) return;
+    atomic_store(&enabled, false);
+    // Sequentially consistent, or it could be ordered before the store above
+    while (atomic_load(&adding) > 0) sched_yield();
+    atomic_store(&running, false);
+    pthread_join(writer, NULL);
+    fclose(file);
+    file = NULL;
+}
+
+void ClearTelemetryFrames(TelemetryFrames *frames) {
+    memset(frames, 0, sizeof(*frames));
+}
+
+void AddTelemetryFrame(TelemetryFrames *frames, float ms) {
+    int bucket = (int)(ms * 4.0f);
+    if (bucket < 0) bucket = 0;
+    if (bucket >= TELEMETRY_FRAME_BUCKETS) bucket = TELEMETRY_FRAME_BUCKETS - 1;
+    frames->buckets[bucket]++;
+    frames->count++;
+    frames->total += ms;
+}
+
+void TelemetryAddFrames(const TelemetryFrames *frames, int attempt, int level) {
+    if (frames->count == 0) return;
+
+    // p99 is the upper edge of the bucket holding the 99th percentile frame
+    int rank = (frames->count * 99 + 99) / 100;
+    int bucket = 0;
+    for (int seen = 0; bucket < TELEMETRY_FRAME_BUCKETS; bucket++) {
+        seen += frames->buckets[bucket];
+        if (seen >= rank) break;
+    }
+    TelemetryRecord record = {
+        .kind = TELEMETRY_FRAMES,
+        .level = (uint16_t)level,
+        .attempt = (uint32_t)attempt,
+        .a = (int16_t)(frames->count > INT16_MAX ? INT16_MAX : frames->count),
+        .x = (float)(frames->total / frames->count),
+        .y = (bucket + 1) / 4.0f,
+    };
+    TelemetryAdd(&record);
+}
@@ -0,0 +1,75 @@
+#ifndef TELEMETRY_H
+#define TELEMETRY_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+// Per-attempt analytics. Records are fixed-size and are pushed from any
+// thread into a lock-free ring without blocking; a background thread
+// writes them out in batches. Records that find the ring full are dropped
+// and counted.
+//
+// Logs are append-only and rotate: prefix-000.aatl up to
+// prefix-NNN.aatl, TELEMETRY_MAX_FILES of them, each closed once it
+// reaches TELEMETRY_FILE_LIMIT bytes. When every file has been used the
+// oldest one is started again. A file is a 16 byte header ("AATL",
+// version, record size, reserved) followed by TELEMETRY_RECORD_SIZE byte
+// little-endian records.
+#define TELEMETRY_MAGIC "AATL"
+#define TELEMETRY_VERSION 1
+#define TELEMETRY_RECORD_SIZE 24
+#define TELEMETRY_RING_SIZE 4096
+#define TELEMETRY_FILE_LIMIT (64L << 20)
+#define TELEMETRY_MAX_FILES 16
+
+typedef enum {
+    TELEMETRY_ATTEMPT_START = 1,
+    TELEMETRY_LAUNCH = 2,       // a = launchSubtick
+    TELEMETRY_COLLISION = 3,    // a, b = pins that collided, x = angle of b on the board
+    TELEMETRY_ATTEMPT_END = 4,  // outcome, a = launches, x = seconds played
+    TELEMETRY_FRAMES = 5,       // frame times over the attempt: a = frames, x = average ms, y = p99 ms
+} TelemetryKind;
+
+typedef enum {
+    TELEMETRY_NONE,
+    TELEMETRY_PASSED,
+    TELEMETRY_FAILED,
+    TELEMETRY_ABANDONED,        // another attempt was started first
+} TelemetryOutcome;
+
+typedef struct {
+    uint8_t kind;
+    uint8_t outcome;
+    uint16_t level;             // ENDLESS_LEVEL for endless runs
+    uint32_t attempt;
+    uint32_t tick;              // step since the attempt started
+    int16_t a, b;
+    float x, y;
+} TelemetryRecord;
+
+void EncodeTelemetryRecord(unsigned char *out, const TelemetryRecord *record);
+TelemetryRecord DecodeTelemetryRecord(const unsigned char *in);
+
+// Starts the writer thread, appending to the most recently written log
+bool StartTelemetry(const char *prefix);
+// Waits for TelemetryAdd() calls already under way, then writes what is
+// still in the ring and stops the writer. Every record added before it
+// returns is either written or counted as dropped.
+void StopTelemetry(void);
+// Safe from any thread. Does nothing unless telemetry is started.
+bool TelemetryAdd(const TelemetryRecord *record);
+long GetTelemetryDropped(void);
+
+// Frame times of one attempt, summarised into a TELEMETRY_FRAMES record
+#define TELEMETRY_FRAME_BUCKETS 256     // 0.25 ms each
+typedef struct {
+    int count;
+    double total;
+    uint32_t buckets[TELEMETRY_FRAME_BUCKETS];
+} TelemetryFrames;
+
+void ClearTelemetryFrames(TelemetryFrames *frames);
+void AddTelemetryFrame(TelemetryFrames *frames, float ms);
+void TelemetryAddFrames(const TelemetryFrames *frames, int attempt, int level);
+
+#endif
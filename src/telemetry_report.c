@@ -0,0 +1,172 @@
+// Offline aggregation of telemetry logs.
+//
+//   cc -O2 -pthread -o aa_telemetry src/telemetry_report.c src/telemetry.c
+//   ./aa_telemetry [--csv] telemetry-*.aatl
+//
+// Reads every log once, front to back, in large blocks, so memory use does
+// not depend on the size of the logs. Prints per level the attempts and
+// their outcomes, the average time to pass and to fail, frame times, and a
+// heatmap of where on the board the failing collisions happened. With
+// --csv the heatmap counts are written as CSV instead, one row per level.
+
+#include "telemetry.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define HEATMAP_BINS 36         // 10 degrees each
+#define READ_RECORDS 65536
+
+typedef struct {
+    long attempts;
+    long outcomes[4];           // by TelemetryOutcome
+    double passSeconds;
+    double failSeconds;
+    long frameAttempts;
+    double frameAverage;        // sums over attempts
+    float frameP99;             // worst over attempts
+    long heatmap[HEATMAP_BINS];
+} LevelStats;
+
+static LevelStats *levels;
+static int levelCapacity;
+
+static LevelStats *GetLevelStats(int level) {
+    if (level >= levelCapacity) {
+        int capacity = levelCapacity > 0 ? levelCapacity : 64;
+        while (capacity <= level) capacity *= 2;
+        LevelStats *grown = realloc(levels, capacity * sizeof(LevelStats));
+        if (!grown) {
+            fprintf(stderr, "out of memory\n");
+            exit(1);
+        }
+        memset(grown + levelCapacity, 0, (capacity - levelCapacity) * sizeof(LevelStats));
+        levels = grown;
+        levelCapacity = capacity;
+    }
+    return &levels[level];
+}
+
+static void Aggregate(const TelemetryRecord *record) {
+    LevelStats *stats = GetLevelStats(record->level);
+    switch (record->kind) {
+        case TELEMETRY_ATTEMPT_START:
+            stats->attempts++;
+            break;
+        case TELEMETRY_COLLISION: {
+            int bin = (int)(record->x / (360.0f / HEATMAP_BINS));
+            if (bin < 0) bin = 0;
+            if (bin >= HEATMAP_BINS) bin = HEATMAP_BINS - 1;
+            stats->heatmap[bin]++;
+        } break;
+        case TELEMETRY_ATTEMPT_END:
+            if (record->outcome > TELEMETRY_ABANDONED) break;
+            stats->outcomes[record->outcome]++;
+            if (record->outcome == TELEMETRY_PASSED) stats->passSeconds += record->x;
+            if (record->outcome == TELEMETRY_FAILED) stats->failSeconds += record->x;
+            break;
+        case TELEMETRY_FRAMES:
+            stats->frameAttempts++;
+            stats->frameAverage += record->x;
+            if (record->y > stats->frameP99) stats->frameP99 = record->y;
+            break;
+        default:
+            break;
+    }
+}
+
+// Returns the number of records read, or -1 if path is not a log
+static long ReadLog(const char *path) {
+    static unsigned char bytes[READ_RECORDS * TELEMETRY_RECORD_SIZE];
+    FILE *file = fopen(path, "rb");
+    if (!file) return -1;
+
+    unsigned char header[16];
+    if (fread(header, 1, sizeof(header), file) != sizeof(header) || memcmp(header, TELEMETRY_MAGIC, 4) != 0 ||
+        header[4] != TELEMETRY_VERSION || header[5] != TELEMETRY_RECORD_SIZE) {
+        fclose(file);
+        return -1;
+    }
+
+    long total = 0;
+    size_t count;
+    while ((count = fread(bytes, TELEMETRY_RECORD_SIZE, READ_RECORDS, file)) > 0) {
+        for (size_t i = 0; i < count; i++) {
+            TelemetryRecord record = DecodeTelemetryRecord(&bytes[i * TELEMETRY_RECORD_SIZE]);
+            Aggregate(&record);
+        }
+        total += (long)count;
+    }
+    fclose(file);
+    return total;
+}
+
+static void PrintHeatmapRow(const long *heatmap) {
+    static const char shades[] = " .:-=+*#%@";
+    long most = 0;
+    for (int b = 0; b < HEATMAP_BINS; b++) {
+        if (heatmap[b] > most) most = heatmap[b];
+    }
+    for (int b = 0; b < HEATMAP_BINS; b++) {
+        int shade = most > 0 ? (int)((heatmap[b] * 9 + most - 1) / most) : 0;
+        putchar(shades[shade]);
+    }
+}
+
+int main(int argc, char **argv) {
+    bool csv = false;
+    int first = 1;
+    if (argc > 1 && strcmp(argv[1], "--csv") == 0) {
+        csv = true;
+        first = 2;
+    }
+    if (first >= argc) {
+        fprintf(stderr, "usage: %s [--csv] log...\n", argv[0]);
+        return 1;
+    }
+
+    long records = 0;
+    int logs = 0;
+    for (int i = first; i < argc; i++) {
+        long read = ReadLog(argv[i]);
+        if (read < 0) {
+            fprintf(stderr, "%s: not a telemetry log\n", argv[i]);
+            continue;
+        }
+        records += read;
+        logs++;
+    }
+
+    if (csv) {
+        printf("level");
+        for (int b = 0; b < HEATMAP_BINS; b++) printf(",%d", b * (360 / HEATMAP_BINS));
+        printf("\n");
+        for (int level = 0; level < levelCapacity; level++) {
+            if (levels[level].attempts == 0) continue;
+            printf("%d", level);
+            for (int b = 0; b < HEATMAP_BINS; b++) printf(",%ld", levels[level].heatmap[b]);
+            printf("\n");
+        }
+        return 0;
+    }
+
+    // Level 0 is endless mode
+    printf("%7s %8s %7s %7s %9s %9s %9s %8s %8s  collisions by board angle, 0..360\n", "level", "attempts",
+           "passed", "failed", "abandoned", "to pass", "to fail", "frame", "p99");
+    for (int level = 0; level < levelCapacity; level++) {
+        LevelStats *s = &levels[level];
+        if (s->attempts == 0) continue;
+        long passed = s->outcomes[TELEMETRY_PASSED], failed = s->outcomes[TELEMETRY_FAILED];
+        char name[16] = "endless";
+        if (level > 0) snprintf(name, sizeof(name), "%d", level);
+        printf("%7s %8ld %7ld %7ld %9ld %8.1fs %8.1fs %6.2fms %6.2fms  |", name, s->attempts, passed, failed,
+               s->outcomes[TELEMETRY_ABANDONED], passed ? s->passSeconds / passed : 0.0,
+               failed ? s->failSeconds / failed : 0.0, s->frameAttempts ? s->frameAverage / s->frameAttempts : 0.0,
+               s->frameP99);
+        PrintHeatmapRow(s->heatmap);
+        printf("|\n");
+    }
+    printf("%ld records from %d logs\n", records, logs);
+    free(levels);
+    return 0;
+}
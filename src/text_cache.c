@@ -0,0 +1,132 @@
+#include "text_cache.h"
+#include <stdio.h>
+#include <string.h>
+
+typedef struct {
+    unsigned int hash;
+    unsigned int fontId;
+    int fontSize;
+    char text[TEXT_CACHE_MAX_LENGTH];
+    Vector2 measured;
+    Texture2D texture;
+    unsigned long lastUsed;
+    unsigned int generation;    // bumped when the slot is reused
+    bool used;
+} TextCacheEntry;
+
+static TextCacheEntry entries[TEXT_CACHE_CAPACITY];
+static unsigned long useCounter = 0;
+
+static unsigned int HashText(const char *text, int fontSize, unsigned int fontId) {
+    unsigned int hash = 2166136261u;
+    for (const char *c = text; *c; c++) {
+        hash = (hash ^ (unsigned char)*c) * 16777619u;
+    }
+    hash = (hash ^ (unsigned int)fontSize) * 16777619u;
+    return (hash ^ fontId) * 16777619u;
+}
+
+void InitTextCache(void) {
+    memset(entries, 0, sizeof(entries));
+    useCounter = 0;
+}
+
+void UnloadTextCache(void) {
+    for (int i = 0; i < TEXT_CACHE_CAPACITY; i++) {
+        if (entries[i].used) UnloadTexture(entries[i].texture);
+        entries[i].used = false;
+    }
+}
+
+static void RenderEntry(TextCacheEntry *entry) {
+    // Rasterized on the CPU so no framebuffer switch is needed, which keeps
+    // it safe while drawing into a render texture. White glyphs so the
+    // texture can be tinted to any colour when drawn.
+    Image image = ImageText(entry->text, entry->fontSize, WHITE);
+    entry->texture = LoadTextureFromImage(image);
+    UnloadImage(image);
+    entry->measured = (Vector2){ (float)entry->texture.width, (float)entry->texture.height };
+}
+
+static int FindEntry(const char *text, int fontSize) {
+    unsigned int fontId = GetFontDefault().texture.id;
+    unsigned int hash = HashText(text, fontSize, fontId);
+    useCounter++;
+
+    int oldest = 0;
+    for (int i = 0; i < TEXT_CACHE_CAPACITY; i++) {
+        TextCacheEntry *entry = &entries[i];
+        if (entry->used && entry->hash == hash && entry->fontSize == fontSize &&
+            entry->fontId == fontId && strcmp(entry->text, text) == 0) {
+            entry->lastUsed = useCounter;
+            return i;
+        }
+        if (!entry->used) {
+            oldest = i;
+        } else if (entries[oldest].used && entry->lastUsed < entries[oldest].lastUsed) {
+            oldest = i;
+        }
+    }
+
+    TextCacheEntry *entry = &entries[oldest];
+    if (entry->used) UnloadTexture(entry->texture);
+    entry->used = true;
+    entry->hash = hash;
+    entry->fontId = fontId;
+    entry->fontSize = fontSize;
+    entry->lastUsed = useCounter;
+    entry->generation++;
+    strncpy(entry->text, text, TEXT_CACHE_MAX_LENGTH - 1);
+    entry->text[TEXT_CACHE_MAX_LENGTH - 1] = '\0';
+    RenderEntry(entry);
+    return oldest;
+}
+
+static void DrawEntry(const TextCacheEntry *entry, int x, int y, Color color) {
+    DrawTexture(entry->texture, x, y, color);
+}
+
+void DrawCachedText(const char *text, int x, int y, int fontSize, Color color) {
+    if (text[0] == '\0') return;
+    // Too long to key on, draw it directly
+    if (strlen(text) >= TEXT_CACHE_MAX_LENGTH) {
+        DrawText(text, x, y, fontSize, color);
+        return;
+    }
+    DrawEntry(&entries[FindEntry(text, fontSize)], x, y, color);
+}
+
+Vector2 MeasureCachedText(const char *text, int fontSize) {
+    // Drawn with DrawText() instead, which spaces glyphs as MeasureText() does
+    if (text[0] == '\0' || strlen(text) >= TEXT_CACHE_MAX_LENGTH) {
+        return (Vector2){ (float)MeasureText(text, fontSize), (float)fontSize };
+    }
+    return entries[FindEntry(text, fontSize)].measured;
+}
+
+void SetTextLabel(TextLabel *label, const char *format, int value, int fontSize) {
+    if (label->valid && label->value == value && label->fontSize == fontSize) return;
+
+    snprintf(label->text, sizeof(label->text), format, value);
+    label->value = value;
+    label->fontSize = fontSize;
+    label->valid = true;
+    label->slot = FindEntry(label->text, fontSize);
+    label->generation = entries[label->slot].generation;
+    label->width = (int)entries[label->slot].measured.x;
+}
+
+void DrawTextLabel(TextLabel *label, int x, int y, Color color) {
+    if (!label->valid) return;
+
+    // The entry may have been evicted and reused for another string
+    TextCacheEntry *entry = &entries[label->slot];
+    if (!entry->used || entry->generation != label->generation) {
+        label->slot = FindEntry(label->text, label->fontSize);
+        entry = &entries[label->slot];
+        label->generation = entry->generation;
+    } else {
+        entry->lastUsed = ++useCounter;
+    }
+    DrawEntry(entry, x, y, color);
+}
@@ -0,0 +1,35 @@
+#ifndef TEXT_CACHE_H
+#define TEXT_CACHE_H
+
+#include "raylib.h"
+
+// Text drawn with the default font is measured and rasterized into a texture
+// the first time a (string, size, font) combination is seen. Later frames
+// only draw that texture. Least recently used entries are evicted.
+#define TEXT_CACHE_CAPACITY 64
+#define TEXT_CACHE_MAX_LENGTH 64
+
+void InitTextCache(void);
+void UnloadTextCache(void);
+
+void DrawCachedText(const char *text, int x, int y, int fontSize, Color color);
+// Size of the text as DrawCachedText() draws it, for centring: the size of
+// the cached texture, which ImageText() makes as wide as MeasureText()
+Vector2 MeasureCachedText(const char *text, int fontSize);
+
+// A label showing one integer. The string is only formatted and looked up
+// again when the value changes.
+typedef struct {
+    int value;
+    int fontSize;
+    int width;          // of the current string as drawn, the texture's width
+    int slot;
+    unsigned int generation;
+    bool valid;
+    char text[TEXT_CACHE_MAX_LENGTH];
+} TextLabel;
+
+void SetTextLabel(TextLabel *label, const char *format, int value, int fontSize);
+void DrawTextLabel(TextLabel *label, int x, int y, Color color);
+
+#endif
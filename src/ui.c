@@ -0,0 +1,131 @@
+#include "ui.h"
+#include "text_cache.h"
+#include <stdlib.h>
+#include <string.h>
+
+void ClearWidgets(WidgetTable *table) {
+    table->count = 0;
+    table->columns = table->rows = 0;
+}
+
+void FreeWidgets(WidgetTable *table) {
+    free(table->widgets);
+    free(table->cellStart);
+    free(table->cellWidgets);
+    memset(table, 0, sizeof(*table));
+}
+
+int AddWidget(WidgetTable *table, Widget widget) {
+    if (table->count == table->capacity) {
+        int capacity = table->capacity > 0 ? table->capacity * 2 : 16;
+        Widget *grown = realloc(table->widgets, capacity * sizeof(Widget));
+        if (!grown) return -1;
+        table->widgets = grown;
+        table->capacity = capacity;
+    }
+    table->widgets[table->count] = widget;
+    return table->count++;
+}
+
+static int Clamp(int v, int lo, int hi) {
+    return v < lo ? lo : (v > hi ? hi : v);
+}
+
+// Cells a widget touches. Bounds include their right and bottom edges.
+static void CellSpan(const WidgetTable *table, Rectangle r, int *x0, int *y0, int *x1, int *y1) {
+    *x0 = Clamp((int)(r.x / UI_CELL_SIZE), 0, table->columns - 1);
+    *y0 = Clamp((int)(r.y / UI_CELL_SIZE), 0, table->rows - 1);
+    *x1 = Clamp((int)((r.x + r.width) / UI_CELL_SIZE), 0, table->columns - 1);
+    *y1 = Clamp((int)((r.y + r.height) / UI_CELL_SIZE), 0, table->rows - 1);
+}
+
+void IndexWidgets(WidgetTable *table, int width, int height) {
+    int columns = (width + UI_CELL_SIZE - 1) / UI_CELL_SIZE;
+    int rows = (height + UI_CELL_SIZE - 1) / UI_CELL_SIZE;
+    if (columns < 1) columns = 1;
+    if (rows < 1) rows = 1;
+    int cells = columns * rows;
+
+    int *cellStart = realloc(table->cellStart, (cells + 1) * sizeof(int));
+    if (!cellStart) return;
+    table->cellStart = cellStart;
+    table->columns = columns;
+    table->rows = rows;
+
+    // Count the widgets per cell, turn the counts into offsets, then fill
+    // each cell in table order
+    memset(cellStart, 0, (cells + 1) * sizeof(int));
+    int total = 0;
+    for (int i = 0; i < table->count; i++) {
+        if (!table->widgets[i].action) continue;
+        int x0, y0, x1, y1;
+        CellSpan(table, table->widgets[i].bounds, &x0, &y0, &x1, &y1);
+        for (int y = y0; y <= y1; y++) {
+            for (int x = x0; x <= x1; x++) cellStart[y * columns + x + 1]++;
+        }
+        total += (x1 - x0 + 1) * (y1 - y0 + 1);
+    }
+    for (int c = 0; c < cells; c++) cellStart[c + 1] += cellStart[c];
+
+    int *cellWidgets = realloc(table->cellWidgets, (total > 0 ? total : 1) * sizeof(int));
+    if (!cellWidgets) {
+        table->columns = table->rows = 0;
+        return;
+    }
+    table->cellWidgets = cellWidgets;
+    int *fill = malloc(cells * sizeof(int));
+    if (!fill) {
+        table->columns = table->rows = 0;
+        return;
+    }
+    memcpy(fill, cellStart, cells * sizeof(int));
+    for (int i = 0; i < table->count; i++) {
+        if (!table->widgets[i].action) continue;
+        int x0, y0, x1, y1;
+        CellSpan(table, table->widgets[i].bounds, &x0, &y0, &x1, &y1);
+        for (int y = y0; y <= y1; y++) {
+            for (int x = x0; x <= x1; x++) cellWidgets[fill[y * columns + x]++] = i;
+        }
+    }
+    free(fill);
+}
+
+int HitTestWidgets(const WidgetTable *table, Vector2 point) {
+    if (table->columns == 0 || point.x < 0 || point.y < 0) return -1;
+    int x = (int)(point.x / UI_CELL_SIZE), y = (int)(point.y / UI_CELL_SIZE);
+    if (x >= table->columns || y >= table->rows) return -1;
+
+    int c = y * table->columns + x;
+    for (int k = table->cellStart[c + 1] - 1; k >= table->cellStart[c]; k--) {
+        Rectangle r = table->widgets[table->cellWidgets[k]].bounds;
+        if (point.x >= r.x && point.x <= r.x + r.width && point.y >= r.y && point.y <= r.y + r.height) {
+            return table->cellWidgets[k];
+        }
+    }
+    return -1;
+}
+
+bool DispatchClick(const WidgetTable *table, Vector2 point) {
+    int i = HitTestWidgets(table, point);
+    if (i < 0) return false;
+    table->widgets[i].action(table->widgets[i].arg);
+    return true;
+}
+
+void DrawWidgets(const WidgetTable *table) {
+    for (int i = 0; i < table->count; i++) {
+        const Widget *w = &table->widgets[i];
+        if (w->style == WIDGET_FILLED) {
+            DrawRectangleRec(w->bounds, w->color);
+        } else if (w->style == WIDGET_OUTLINED) {
+            DrawRectangleLines((int)w->bounds.x, (int)w->bounds.y, (int)w->bounds.width, (int)w->bounds.height, w->color);
+        }
+    }
+    for (int i = 0; i < table->count; i++) {
+        const Widget *w = &table->widgets[i];
+        if (!w->label || !w->label[0]) continue;
+        Vector2 size = MeasureCachedText(w->label, w->fontSize);
+        DrawCachedText(w->label, (int)(w->bounds.x + (w->bounds.width - size.x) / 2),
+                       (int)(w->bounds.y + (w->bounds.height - size.y) / 2), w->fontSize, w->labelColor);
+    }
+}
@@ -0,0 +1,60 @@
+#ifndef UI_H
+#define UI_H
+
+#include "raylib.h"
+
+// Retained widgets for the menu scenes. A scene's widgets are laid out
+// once into a table, and again only when the window size changes. A grid
+// of UI_CELL_SIZE cells over the table lists the widgets touching each
+// cell, so a click looks at the few widgets in one cell however many the
+// scene has. Drawing walks the same table: every box first, then every
+// label, so the boxes go out as one batch.
+#define UI_CELL_SIZE 64
+
+typedef enum {
+    WIDGET_FILLED,      // filled box, label centred on it
+    WIDGET_OUTLINED,    // box outline, label centred in it
+    WIDGET_LABEL,       // label only
+} WidgetStyle;
+
+typedef void (*WidgetAction)(int arg);
+
+typedef struct {
+    Rectangle bounds;
+    WidgetStyle style;
+    // May point at a string the scene updates; drawn through the text cache
+    const char *label;
+    int fontSize;
+    Color color;            // of the box
+    Color labelColor;
+    WidgetAction action;    // NULL for widgets that ignore clicks
+    int arg;                // passed to action
+} Widget;
+
+typedef struct {
+    Widget *widgets;
+    int count;
+    int capacity;
+    // Widgets touching grid cell c are cellWidgets[cellStart[c]] up to
+    // cellWidgets[cellStart[c + 1]], in table order
+    int columns, rows;
+    int *cellStart;
+    int *cellWidgets;
+} WidgetTable;
+
+// Empties the table, keeping its memory for the next layout
+void ClearWidgets(WidgetTable *table);
+void FreeWidgets(WidgetTable *table);
+// Returns the widget's index, or -1 when out of memory
+int AddWidget(WidgetTable *table, Widget widget);
+// Builds the grid over a width x height area, rounded up to whole cells.
+// Call once the widgets are added; clicks outside the grid hit nothing.
+void IndexWidgets(WidgetTable *table, int width, int height);
+
+// Index of the last added widget with an action under point, -1 if none
+int HitTestWidgets(const WidgetTable *table, Vector2 point);
+// Runs the action of the widget under point. Returns whether one ran.
+bool DispatchClick(const WidgetTable *table, Vector2 point);
+void DrawWidgets(const WidgetTable *table);
+
+#endif
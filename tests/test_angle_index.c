@@ -0,0 +1,128 @@
+// Checks AngleIndexFindNear() against a scan of every stored angle, on
+// random boards and on angles exactly COLLISION_ANGLE apart, including
+// boards that straddle the wrap from 2^32 - 1 back to 0.
+#include "game.h"
+#include <stdio.h>
+
+#define BOARDS 2000
+#define QUERIES 200
+
+static uint32_t rngState = 12345;
+
+static uint32_t Random(void) {
+    rngState ^= rngState << 13;
+    rngState ^= rngState >> 17;
+    rngState ^= rngState << 5;
+    return rngState;
+}
+
+// Distance going round from a up to b
+static BinaryAngle Forward(BinaryAngle a, BinaryAngle b) {
+    return b - a;
+}
+
+// The index only looks at the stored angles either side of the query, so
+// it must find a pin exactly when some pin is in range, only pins that
+// are, and always the nearest one
+static int CheckQuery(const AngleIndex *index, BinaryAngle angle, BinaryAngle threshold) {
+    int hits[2];
+    int found = AngleIndexFindNear(index, angle, threshold, hits);
+
+    int inRange = 0;
+    BinaryAngle nearest = UINT32_MAX;
+    for (int i = 0; i < index->count; i++) {
+        BinaryAngle after = Forward(angle, index->angles[i]);
+        BinaryAngle before = Forward(index->angles[i], angle);
+        BinaryAngle distance = after < before ? after : before;
+        if (distance < threshold) inRange++;
+        if (distance < nearest) nearest = distance;
+    }
+
+    bool ok = (found > 0) == (inRange > 0) && found <= inRange;
+    bool nearestFound = found == 0;
+    for (int h = 0; h < found; h++) {
+        BinaryAngle stored = index->angles[0];
+        for (int i = 0; i < index->count; i++) {
+            if (index->pins[i] == hits[h]) stored = index->angles[i];
+        }
+        BinaryAngle after = Forward(angle, stored), before = Forward(stored, angle);
+        BinaryAngle distance = after < before ? after : before;
+        if (distance >= threshold) ok = false;
+        if (distance == nearest) nearestFound = true;
+    }
+    if (found == 2 && hits[0] == hits[1]) ok = false;
+    if (!ok || !nearestFound) {
+        fprintf(stderr, "query %08x threshold %08x: %d found, %d in range\n", (unsigned)angle, (unsigned)threshold,
+                found, inRange);
+        return 1;
+    }
+    return 0;
+}
+
+// Exact answers for a pin at stored and a query threshold - 1, threshold
+// and threshold + 1 away on either side
+static int CheckBoundary(BinaryAngle stored, BinaryAngle threshold) {
+    AngleIndex index;
+    AngleIndexClear(&index);
+    AngleIndexInsert(&index, stored, 7);
+
+    int failures = 0;
+    for (int side = -1; side <= 1; side += 2) {
+        for (int d = -1; d <= 1; d++) {
+            BinaryAngle offset = threshold + (BinaryAngle)d;
+            BinaryAngle angle = side > 0 ? stored + offset : stored - offset;
+            int hits[2];
+            int found = AngleIndexFindNear(&index, angle, threshold, hits);
+            int expected = d < 0 ? 1 : 0;
+            if (found != expected || (found == 1 && hits[0] != 7)) {
+                fprintf(stderr, "pin at %08x, query %08x: %d found, expected %d\n", (unsigned)stored, (unsigned)angle,
+                        found, expected);
+                failures++;
+            }
+        }
+    }
+    return failures + CheckQuery(&index, stored + threshold, threshold) + CheckQuery(&index, stored - threshold, threshold);
+}
+
+int main(void) {
+    int failures = 0;
+
+    // Pins right at and either side of the wrap
+    BinaryAngle edges[] = { 0, 1, UINT32_MAX, UINT32_MAX - COLLISION_ANGLE, COLLISION_ANGLE, COLLISION_ANGLE - 1,
+                            BINARY_ANGLE_QUARTER, 0x80000000u };
+    for (int i = 0; i < (int)(sizeof(edges) / sizeof(edges[0])); i++) {
+        failures += CheckBoundary(edges[i], COLLISION_ANGLE);
+        failures += CheckBoundary(edges[i], 1);
+    }
+
+    for (int board = 0; board < BOARDS; board++) {
+        AngleIndex index;
+        AngleIndexClear(&index);
+        // Every other board keeps its pins within a few thresholds of 0,
+        // so most queries wrap
+        bool nearWrap = board % 2 == 1;
+        int pins = 1 + (int)(Random() % MAX_RING_PINS);
+        for (int p = 0; p < pins; p++) {
+            BinaryAngle angle = nearWrap ? (BinaryAngle)(Random() % (4 * COLLISION_ANGLE)) - 2 * COLLISION_ANGLE
+                                         : Random();
+            AngleIndexInsert(&index, angle, p);
+        }
+
+        for (int q = 0; q < QUERIES; q++) {
+            BinaryAngle threshold = q % 2 == 0 ? COLLISION_ANGLE : 1 + Random() % 0x80000000u;
+            BinaryAngle angle;
+            if (q % 4 < 2) {
+                // Exactly at, just inside or just outside a stored pin's range
+                BinaryAngle stored = index.angles[Random() % index.count];
+                BinaryAngle offset = threshold + (BinaryAngle)(int)(Random() % 3) - 1;
+                angle = Random() % 2 ? stored + offset : stored - offset;
+            } else {
+                angle = nearWrap ? (BinaryAngle)(Random() % (6 * COLLISION_ANGLE)) - 3 * COLLISION_ANGLE : Random();
+            }
+            failures += CheckQuery(&index, angle, threshold);
+        }
+    }
+
+    if (failures == 0) printf("angle index: %d boards agree with a full scan\n", BOARDS);
+    return failures ? 1 : 0;
+}
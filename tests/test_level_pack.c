@@ -0,0 +1,147 @@
+// Writes the built-in levels to a pack as aa_levelpack does, maps it back
+// and compares every level field by field. Damaged copies of the pack must
+// be refused.
+#include "level_pack.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define PACK_PATH "test_level_pack.aalp"
+#define DAMAGED_PATH "test_level_pack_damaged.aalp"
+#define LEVELS 100
+
+static int failures = 0;
+
+#define CHECK_FIELD(level, field, a, b)                                                    \
+    do {                                                                                   \
+        if ((a) != (b)) {                                                                  \
+            fprintf(stderr, "level %d: %s differs after the round trip\n", level, field); \
+            failures++;                                                                    \
+        }                                                                                  \
+    } while (0)
+
+static void CompareLevel(int level, const LevelRecord *want, const LevelRecord *got) {
+    CHECK_FIELD(level, "level_pin", want->level_pin, got->level_pin);
+    CHECK_FIELD(level, "obstacleCount", want->obstacleCount, got->obstacleCount);
+    for (int i = 0; i < MAX_OBSTACLES; i++) {
+        CHECK_FIELD(level, "obstacleAngles", want->obstacleAngles[i], got->obstacleAngles[i]);
+    }
+    CHECK_FIELD(level, "phase", want->phase, got->phase);
+    CHECK_FIELD(level, "segmentCount", want->segmentCount, got->segmentCount);
+    CHECK_FIELD(level, "reserved", want->reserved, got->reserved);
+    for (int i = 0; i < MAX_ROTATION_SEGMENTS; i++) {
+        CHECK_FIELD(level, "segments.end", want->segments[i].end, got->segments[i].end);
+        CHECK_FIELD(level, "segments.step", want->segments[i].step, got->segments[i].step);
+    }
+    // The whole rotation cycle plays the same from the mapped record
+    long cycle = want->segmentCount > 0 ? want->segments[want->segmentCount - 1].end : 1;
+    for (long tick = 0; tick < cycle; tick++) {
+        if (LevelRotationStep(want, tick) != LevelRotationStep(got, tick)) {
+            fprintf(stderr, "level %d: rotation differs at step %ld\n", level, tick);
+            failures++;
+            break;
+        }
+    }
+}
+
+static unsigned char *ReadAll(const char *path, long *size) {
+    FILE *file = fopen(path, "rb");
+    if (!file) return NULL;
+    fseek(file, 0, SEEK_END);
+    *size = ftell(file);
+    fseek(file, 0, SEEK_SET);
+    unsigned char *bytes = malloc(*size);
+    if (bytes && fread(bytes, 1, *size, file) != (size_t)*size) {
+        free(bytes);
+        bytes = NULL;
+    }
+    fclose(file);
+    return bytes;
+}
+
+// Writes the first size bytes of the pack to DAMAGED_PATH, with the byte
+// at change[0] set to change[1] when change is given
+static bool WriteCopy(const unsigned char *bytes, long size, const long *change) {
+    FILE *file = fopen(DAMAGED_PATH, "wb");
+    if (!file) {
+        fprintf(stderr, "cannot write %s\n", DAMAGED_PATH);
+        failures++;
+        return false;
+    }
+    fwrite(bytes, 1, size, file);
+    if (change) {
+        fseek(file, change[0], SEEK_SET);
+        fputc((int)change[1], file);
+    }
+    fclose(file);
+    return true;
+}
+
+// Expects the loader to refuse a damaged copy
+static void ExpectRejected(const char *what, const unsigned char *bytes, long size, const long *change) {
+    if (!WriteCopy(bytes, size, change)) return;
+    LevelPack pack;
+    if (LoadLevelPack(&pack, DAMAGED_PATH)) {
+        fprintf(stderr, "%s: loaded\n", what);
+        failures++;
+        UnloadLevelPack(&pack);
+    }
+    remove(DAMAGED_PATH);
+}
+
+int main(void) {
+    static LevelRecord records[LEVELS];
+    for (int i = 0; i < LEVELS; i++) BuiltinLevel(i + 1, &records[i]);
+    if (!WriteLevelPack(PACK_PATH, records, LEVELS)) {
+        fprintf(stderr, "cannot write %s\n", PACK_PATH);
+        return 1;
+    }
+
+    LevelPack pack;
+    if (!LoadLevelPack(&pack, PACK_PATH)) {
+        fprintf(stderr, "%s: written pack does not load back\n", PACK_PATH);
+        return 1;
+    }
+    CHECK_FIELD(0, "levelCount", pack.header->levelCount, (uint32_t)LEVELS);
+    CHECK_FIELD(0, "firstLevel", pack.header->firstLevel, 1u);
+    uint32_t id = LevelPackId(&pack);
+    CHECK_FIELD(0, "pack id", id != 0, true);
+    for (int level = 1; level <= LEVELS; level++) {
+        CompareLevel(level, &records[level - 1], GetPackLevel(&pack, level));
+    }
+    // Numbers outside the pack clamp to its first and last levels
+    CHECK_FIELD(0, "level below the pack", GetPackLevel(&pack, 0), &pack.records[0]);
+    CHECK_FIELD(0, "level past the pack", GetPackLevel(&pack, LEVELS + 5), &pack.records[LEVELS - 1]);
+    UnloadLevelPack(&pack);
+
+    long size = 0;
+    unsigned char *bytes = ReadAll(PACK_PATH, &size);
+    remove(PACK_PATH);
+    if (!bytes) {
+        fprintf(stderr, "cannot read back %s\n", PACK_PATH);
+        return 1;
+    }
+    // A version 1 pack has no CRC in its header; its id is computed from
+    // the records and comes out the same
+    if (WriteCopy(bytes, size, (const long[]){ 4, 1 })) {
+        if (!LoadLevelPack(&pack, DAMAGED_PATH)) {
+            fprintf(stderr, "version 1 pack: not loaded\n");
+            failures++;
+        } else {
+            CHECK_FIELD(0, "version 1 pack id", LevelPackId(&pack), id);
+            UnloadLevelPack(&pack);
+        }
+        remove(DAMAGED_PATH);
+    }
+    ExpectRejected("empty file", bytes, 0, NULL);
+    ExpectRejected("header cut short", bytes, sizeof(LevelPackHeader) - 1, NULL);
+    ExpectRejected("last level cut short", bytes, size - 1, NULL);
+    ExpectRejected("bad magic", bytes, size, (const long[]){ 0, 'X' });
+    ExpectRejected("unknown version", bytes, size, (const long[]){ 4, LEVEL_PACK_VERSION + 1 });
+    ExpectRejected("wrong record size", bytes, size, (const long[]){ 16, 0 });
+    ExpectRejected("misaligned records", bytes, size, (const long[]){ 20, sizeof(LevelPackHeader) + 4 });
+    free(bytes);
+
+    if (failures == 0) printf("level pack: %d levels round trip, damaged packs refused\n", LEVELS);
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,163 @@
+// Plays an endless run on the simulation thread against a fake clock, with
+// a launch pressed just before stage 2 started but handled after it, and
+// checks that replaying the recording gives the same board at every tick
+// the replay reaches.
+#define _POSIX_C_SOURCE 199309L
+#include "recording.h"
+#include "sim_thread.h"
+#include <stdatomic.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+
+#define RECORDING_PATH "test_stage_replay.aarc"
+#define MAX_TICKS 20000
+// Steps into stage 2 the late launch is handled at, and how far back
+// before the stage start it was pressed
+#define LATE_BY 3
+#define PRESSED_BEFORE 2
+#define RUN_AFTER (4 * SIM_HZ)
+// Presses land half way through their step
+#define PRESS_SUBTICK (GAME_SUBTICKS / 2)
+
+static _Atomic double fakeNow = 1.0;
+static double startTime;
+static unsigned long long liveHash[MAX_TICKS];
+static bool planned[MAX_TICKS];
+
+static double FakeClock(void) {
+    return atomic_load(&fakeNow);
+}
+
+static unsigned long long HashPins(const PinSet *pins) {
+    unsigned long long h = 1469598103934665603ull;
+    for (int i = 0; i < pins->count; i++) {
+        uint32_t y;
+        memcpy(&y, &pins->yOffset[i], sizeof(y));
+        h = (h ^ pins->angle[i]) * 1099511628211ull;
+        h = (h ^ y) * 1099511628211ull;
+        h = (h ^ pins->collided[i]) * 1099511628211ull;
+    }
+    return (h ^ (unsigned)pins->count ^ ((unsigned long long)pins->attachedCount << 32)) * 1099511628211ull;
+}
+
+// Launches only when nothing is in flight and the pin would attach clear of
+// the inner ring, as the bench autoplayer does
+static bool SafeToLaunch(const GameState *state) {
+    if (state->pins.attachedCount != state->pins.count) return false;
+    if (state->pins.count >= state->level_pin) return false;
+
+    BinaryAngle boardAngle = state->boardAngle;
+    float y = PIN_LAUNCH_OFFSET;
+    for (long s = 1; y > ATTACH_RADIUS; s++) {
+        y -= PIN_SPEED;
+        boardAngle += DegreesToAngle(LevelRotationStep(&state->levelRecord, state->tick + s));
+    }
+    int hits[2];
+    BinaryAngle rel = BoardRelativeAngle(boardAngle, LAUNCH_ANGLE);
+    return AngleIndexFindNear(&state->attachedIndex, rel, COLLISION_ANGLE + DegreesToAngle(1.0), hits) == 0;
+}
+
+// Plans the launches that pass the first stage. Returns the tick stage 2
+// starts at, -1 if the plan failed.
+static long PlanFirstStage(void) {
+    static GameState state;
+    InitGameState(&state);
+    StartEndless(&state);
+    long stageStart = -1;
+    while (state.tick < MAX_TICKS && stageStart < 0) {
+        long tick = state.tick;
+        GameInput input = { .launch = SafeToLaunch(&state), .launchSubtick = PRESS_SUBTICK };
+        int events = GameUpdate(&state, input);
+        if (events & GAME_EVENT_LAUNCH) planned[tick] = true;
+        if (events & (GAME_EVENT_COLLISION | GAME_EVENT_FAIL)) break;
+        if (events & GAME_EVENT_STAGE_PASSED) stageStart = state.stageStartTick;
+    }
+    FreeGameState(&state);
+    return stageStart;
+}
+
+// Moves the clock to just short of the end of step `steps` and waits for
+// the simulation to publish it
+static const GameSnapshot *RunTo(long steps) {
+    atomic_store(&fakeNow, startTime + (steps + 0.99) * SIM_DT);
+    for (int wait = 0; wait < 10000; wait++) {
+        const GameSnapshot *snapshot = SimLatestSnapshot();
+        if (snapshot->tick >= steps || snapshot->status != SIM_PLAYING) return snapshot;
+        nanosleep(&(struct timespec){ 0, 100000 }, NULL);
+    }
+    return NULL;
+}
+
+static double PressTime(long tick) {
+    return startTime + (tick + (double)PRESS_SUBTICK / GAME_SUBTICKS) * SIM_DT;
+}
+
+int main(void) {
+    long stageStart = PlanFirstStage();
+    if (stageStart < PRESSED_BEFORE || stageStart + LATE_BY + RUN_AFTER >= MAX_TICKS) {
+        fprintf(stderr, "could not plan the first endless stage\n");
+        return 1;
+    }
+
+    Recorder recorder;
+    if (!RecorderOpen(&recorder, RECORDING_PATH, RECORDING_BUILTIN_LEVELS)) {
+        fprintf(stderr, "cannot write %s\n", RECORDING_PATH);
+        return 1;
+    }
+    StartSimThread(FakeClock, &recorder);
+    startTime = FakeClock();
+    int attempt = SimStartLevel(ENDLESS_LEVEL);
+    while (SimLatestSnapshot()->attempt != attempt) nanosleep(&(struct timespec){ 0, 100000 }, NULL);
+
+    long lastTick = -1;
+    for (long tick = 0; tick < stageStart + LATE_BY + RUN_AFTER; tick++) {
+        if (planned[tick]) SimLaunch(PressTime(tick));
+        if (tick == stageStart + LATE_BY) SimLaunch(PressTime(stageStart - PRESSED_BEFORE));
+        const GameSnapshot *snapshot = RunTo(tick + 1);
+        if (!snapshot) {
+            fprintf(stderr, "simulation stalled at tick %ld\n", tick);
+            return 1;
+        }
+        liveHash[snapshot->tick] = HashPins(&snapshot->pins);
+        lastTick = snapshot->tick;
+        if (snapshot->status != SIM_PLAYING) break;
+    }
+    StopSimThread();
+    RecorderClose(&recorder);
+
+    Recording recording;
+    if (!LoadRecording(&recording, RECORDING_PATH) || recording.count < 2) {
+        fprintf(stderr, "cannot read back %s\n", RECORDING_PATH);
+        return 1;
+    }
+    remove(RECORDING_PATH);
+
+    int failures = 0;
+    const Record *late = &recording.records[recording.count - 1];
+    if (late->kind != RECORD_LAUNCH || late->tick != (uint32_t)stageStart) {
+        fprintf(stderr, "late launch recorded at tick %u, stage 2 starts at %ld\n", late->tick, stageStart);
+        failures++;
+    }
+
+    static GameState state;
+    InitGameState(&state);
+    ReplayResult result;
+    ReplayAttempt(&recording, 0, &state, &result);
+    if (result.ticks > lastTick) {
+        fprintf(stderr, "replay ran to tick %ld, the live run stopped at %ld\n", result.ticks, lastTick);
+        failures++;
+    } else if (HashPins(&state.pins) != liveHash[result.ticks]) {
+        fprintf(stderr, "replay differs from the live run at tick %ld\n", result.ticks);
+        failures++;
+    }
+    if (result.stage != 2) {
+        fprintf(stderr, "replay ended in stage %d, expected 2\n", result.stage);
+        failures++;
+    }
+
+    FreeGameState(&state);
+    UnloadRecording(&recording);
+    if (failures == 0) printf("stage replay: late launch at tick %ld replays identically\n", stageStart);
+    return failures ? 1 : 0;
+}